@@ -60,7 +60,10 @@ typedef struct _AddressSpace {
 
 extern _Area _heap;
 void _putc(char ch);
+void _putstr(const char *s, size_t len); // optional, klib falls back to _putc()
 void _halt(int code) __attribute__((__noreturn__));
+void __cxa_finalize(void *dso) __attribute__((weak)); // called by _halt() if linked, runs atexit() functions
+void __printf_flush(void) __attribute__((weak)); // called by _halt() if linked, writes out buffered printf() lines
 
 // ======================= I/O Extension (IOE) =======================
 
@@ -25,11 +25,16 @@ extern "C" {
 
 // ================= Device Register Specifications ==================
 
+_AM_DEVREG(PERFCNT, READ,   1, uint32_t valid; uint64_t cycle, instret, cachemiss, brmiss);
 _AM_DEVREG(INPUT,   KBD,    1, int keydown, keycode);
 _AM_DEVREG(TIMER,   UPTIME, 1, uint32_t hi, lo);
 _AM_DEVREG(TIMER,   DATE,   2, int year, month, day, hour, minute, second);
+_AM_DEVREG(TIMER,   USEC,   3, uint64_t us);
+_AM_DEVREG(TIMER,   CYCLE,  4, uint64_t cycle);
 _AM_DEVREG(VIDEO,   INFO,   1, int width, height);
 _AM_DEVREG(VIDEO,   FBCTRL, 2, int x, y; uint32_t *pixels; int w, h, sync);
+_AM_DEVREG(VIDEO,   FBADDR, 3, uint32_t *pixels; int width, height);
+_AM_DEVREG(VIDEO,   PRESENT,4, int x, y, w, h);
 _AM_DEVREG(SERIAL,  RECV,   1, uint8_t data);
 _AM_DEVREG(SERIAL,  SEND,   2, uint8_t data);
 _AM_DEVREG(SERIAL,  STAT,   3, uint8_t data);
@@ -37,9 +42,17 @@ _AM_DEVREG(SERIAL,  CTRL,   4, uint8_t data);
 _AM_DEVREG(STORAGE, INFO,   1, uint32_t blksz, blkcnt);
 _AM_DEVREG(STORAGE, RDCTRL, 2, void *buf; uint32_t blkno, blkcnt);
 _AM_DEVREG(STORAGE, WRCTRL, 3, void *buf; uint32_t blkno, blkcnt);
+_AM_DEVREG(STORAGE, MAP,    4, void *addr);
 _AM_DEVREG(AUDIO,   INIT,   1, uint32_t freq, channels, samples, bufsize);
 _AM_DEVREG(AUDIO,   SBCTRL, 2, uint8_t *stream; int len, wait);
 _AM_DEVREG(AUDIO,   SBSTAT, 3, int bufsize, count);
+// Valid bits of _DEV_PERFCNT_READ_t, set for counters supported by the backend
+enum {
+  _PERFCNT_CYCLE     = 0x1,
+  _PERFCNT_INSTRET   = 0x2,
+  _PERFCNT_CACHEMISS = 0x4,
+  _PERFCNT_BRMISS    = 0x8,
+};
 #define _DEVREG_PCICONF(bus, slot, func, offset) \
   ((uint32_t)(   1) << 31) | ((uint32_t)( bus) << 16) | \
   ((uint32_t)(slot) << 11) | ((uint32_t)(func) <<  8) | (offset)
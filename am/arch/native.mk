@@ -4,18 +4,21 @@ AM_SRCS := native/trm.c \
            native/trap.S \
            native/vme.c \
            native/mpe.c \
+           native/thread.c \
            native/platform.c \
            native/devices/input.c \
            native/devices/timer.c \
+           native/devices/perfcnt.c \
            native/devices/video.c \
            native/devices/audio.c \
+           native/devices/storage.c \
 
 CFLAGS  += -fpie
 ASFLAGS += -fpie -pie
 
 image:
 	@echo + LD "->" $(BINARY_REL)
-	@g++ -pie -o $(BINARY) -Wl,--whole-archive $(LINK_FILES) -Wl,-no-whole-archive -lSDL2 -lGL -lrt
+	@g++ -pie -o $(BINARY) -Wl,--whole-archive $(LINK_FILES) -Wl,-no-whole-archive -lSDL2 -lGL -lrt -lpthread
 
 run:
 	$(BINARY)
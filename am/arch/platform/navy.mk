@@ -3,6 +3,8 @@ AM_SRCS := navy/trm.c \
            navy/dev/input.c \
            navy/dev/timer.c \
            dummy/audio.c \
+           dummy/mpe.c \
+           dummy/perfcnt.c \
            navy/dev/video.c
 
 NAVY_MAKEFILE = Makefile.navy
@@ -3,6 +3,7 @@ AM_SRCS += nemu/common/trm.c \
            nemu/common/ioe.c \
            nemu/common/input.c \
            nemu/common/timer.c \
+           dummy/perfcnt.c \
            nemu/common/video.c \
            nemu/common/audio.c \
            dummy/mpe.c \
@@ -3,6 +3,7 @@ AM_SRCS += sdi/trm.c \
            nemu/common/ioe.c \
            nemu/common/input.c \
            nemu/common/timer.c \
+           dummy/perfcnt.c \
            nemu/common/video.c \
            dummy/audio.c \
            dummy/cte.c \
@@ -11,6 +11,7 @@ AM_SRCS := nutshell/isa/riscv/trm.c \
            dummy/cte.c \
            dummy/vme.c \
            dummy/mpe.c \
+           dummy/perfcnt.c \
            nutshell/isa/riscv/boot/start.S
 
 CFLAGS  += -I$(AM_HOME)/am/src/nutshell/include -DISA_H=\"riscv.h\"
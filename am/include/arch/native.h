@@ -10,6 +10,7 @@
 struct _Context {
   uintptr_t ksp;
   void *vm_head;
+  int fast; // saved by _yield() in kernel, can be restored without a signal
   ucontext_t uc;
   // skip the red zone of the stack frame, see the amd64 ABI manual for details
   uint8_t redzone[128];
@@ -326,6 +326,20 @@ static inline intptr_t xchg(volatile intptr_t *addr, intptr_t newval) {
   return result;
 }
 
+static inline void cpuid(uint32_t leaf, uint32_t *eax, uint32_t *ebx, uint32_t *ecx, uint32_t *edx) {
+  asm volatile ("cpuid": "=a"(*eax), "=b"(*ebx), "=c"(*ecx), "=d"(*edx) : "a"(leaf), "c"(0));
+}
+
+static inline uint64_t rdmsr(uint32_t msr) {
+  uint32_t lo, hi;
+  asm volatile ("rdmsr": "=a"(lo), "=d"(hi) : "c"(msr));
+  return ((uint64_t)hi << 32) | lo;
+}
+
+static inline void wrmsr(uint32_t msr, uint64_t val) {
+  asm volatile ("wrmsr": : "c"(msr), "a"((uint32_t)val), "d"((uint32_t)(val >> 32)));
+}
+
 static inline uint64_t rdtsc() {
   uint32_t lo, hi;
   asm volatile ("rdtsc": "=a"(lo), "=d"(hi));
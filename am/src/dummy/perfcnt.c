@@ -0,0 +1,17 @@
+#include <am.h>
+#include <amdev.h>
+
+void __am_perfcnt_init() {
+}
+
+size_t __am_perfcnt_dev_read(uintptr_t reg, void *buf, size_t size) {
+  switch (reg) {
+    case _DEVREG_PERFCNT_READ: {
+      _DEV_PERFCNT_READ_t *cnt = (_DEV_PERFCNT_READ_t *)buf;
+      cnt->valid = 0;
+      cnt->cycle = cnt->instret = cnt->cachemiss = cnt->brmiss = 0;
+      return sizeof(_DEV_PERFCNT_READ_t);
+    }
+  }
+  return 0;
+}
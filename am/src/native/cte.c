@@ -1,8 +1,5 @@
-#include <sys/time.h>
 #include "platform.h"
 
-#define TIMER_HZ 100
-
 #define YIELD_INSTR "0xff,0x14,0x25,0x08,0x00,0x10,0x00" // callq *0x100008
 #define YIELD_INSTR_LEN ((sizeof(YIELD_INSTR)) / 5)  // sizeof() counts the '\0' byte
 #define SYSCALL_INSTR_LEN YIELD_INSTR_LEN
@@ -14,6 +11,7 @@ static_assert(SYSCALL_INSTR_LEN == 7);
 static _Context* (*user_handler)(_Event, _Context*) = NULL;
 
 void __am_kcontext_start();
+void __am_fast_iret(uintptr_t *regs);
 void __am_switch(_Context *c);
 int __am_in_userspace(void *addr);
 void __am_pmem_protect();
@@ -21,18 +19,71 @@ void __am_pmem_unprotect();
 
 void __am_panic_on_return() { panic("should not reach here\n"); }
 
+// layout of the buffer passed to __am_fast_iret(), keep it consistent with trap.S
+enum { FAST_RBX, FAST_RBP, FAST_R12, FAST_R13, FAST_R14, FAST_R15, FAST_RDI, FAST_RSI,
+  FAST_RSP, FAST_RIP, FAST_SIGMASK, FAST_MXCSR, FAST_FPUCW, NR_FAST };
+
+static void fast_iret(_Context *c) {
+  greg_t *gregs = c->uc.uc_mcontext.gregs;
+  // Copy out everything needed, since __am_fast_iret() pushes data to the
+  // target stack, and it may overlap with the context.
+  uintptr_t regs[NR_FAST] = {
+    [FAST_RBX] = gregs[REG_RBX], [FAST_RBP] = gregs[REG_RBP],
+    [FAST_R12] = gregs[REG_R12], [FAST_R13] = gregs[REG_R13],
+    [FAST_R14] = gregs[REG_R14], [FAST_R15] = gregs[REG_R15],
+    [FAST_RDI] = gregs[REG_RDI], [FAST_RSI] = gregs[REG_RSI],
+    [FAST_RSP] = gregs[REG_RSP], [FAST_RIP] = gregs[REG_RIP],
+    // the kernel only uses the first 64 bits of the signal mask on x86-64
+    [FAST_SIGMASK] = c->uc.uc_sigmask.__val[0],
+    [FAST_MXCSR] = c->uc.__fpregs_mem.mxcsr,
+    [FAST_FPUCW] = c->uc.__fpregs_mem.cwd,
+  };
+  __am_fast_iret(regs);
+}
+
+static void iret_to(_Context *c) {
+  __am_switch(c);
+
+  if (c->fast) {
+    // a context saved in kernel by _yield() or created by _kcontext() only
+    // contains callee-saved registers, and can be restored in user level
+    thiscpu->ksp = c->ksp;
+    fast_iret(c);
+  } else {
+    // magic call to restore context
+    asm volatile("call *0x100010" : : "a" (c));
+  }
+  __am_panic_on_return();
+}
+
 static void irq_handle(_Context *c) {
   c->vm_head = thiscpu->vm_head;
   c->ksp = thiscpu->ksp;
+  c->fast = 0;
 
   c = user_handler(thiscpu->ev, c);
   assert(c != NULL);
 
-  __am_switch(c);
+  iret_to(c);
+}
 
-  // magic call to restore context
-  asm volatile("call *0x100010" : : "a" (c));
-  __am_panic_on_return();
+// called by _yield() with the callee-saved registers in `c`
+void __am_fast_yield(_Context *c) {
+  // disable interrupt as a trap does
+  extern sigset_t __am_intr_sigmask;
+  int ret = sigprocmask(SIG_BLOCK, &__am_intr_sigmask, &c->uc.uc_sigmask);
+  assert(ret == 0);
+
+  c->vm_head = thiscpu->vm_head;
+  c->ksp = thiscpu->ksp;
+  c->fast = 1;
+
+  thiscpu->ev = (_Event) {0};
+  thiscpu->ev.event = _EVENT_YIELD;
+  c = user_handler(thiscpu->ev, c);
+  assert(c != NULL);
+
+  iret_to(c);
 }
 
 static void setup_stack(uintptr_t event, ucontext_t *uc) {
@@ -65,6 +116,8 @@ static void setup_stack(uintptr_t event, ucontext_t *uc) {
   // switch to kernel stack if we were previously in user space
   _Context *c = (void *)(trap_from_user ? thiscpu->ksp : uc->uc_mcontext.gregs[REG_RSP]);
   c --;
+  // keep the stack aligned as the amd64 ABI requires
+  c = (void *)ROUNDDOWN(c, 16);
 
   // save the context on the stack
   c->uc = *uc;
@@ -75,7 +128,8 @@ static void setup_stack(uintptr_t event, ucontext_t *uc) {
   // call irq_handle after returning from the signal handler
   uc->uc_mcontext.gregs[REG_RDI] = (uintptr_t)c;
   uc->uc_mcontext.gregs[REG_RIP] = (uintptr_t)irq_handle;
-  uc->uc_mcontext.gregs[REG_RSP] = (uintptr_t)c;
+  // pretend that irq_handle is called, so that (rsp + 8) is a multiple of 16
+  uc->uc_mcontext.gregs[REG_RSP] = (uintptr_t)c - sizeof(uintptr_t);
 }
 
 static void iret(ucontext_t *uc) {
@@ -123,7 +177,7 @@ static void sig_handler(int sig, siginfo_t *info, void *ucontext) {
   setup_stack(thiscpu->ev.event, ucontext);
 }
 
-// signal handlers are inherited across fork()
+// signal handlers are shared by all threads
 static void install_signal_handler() {
   struct sigaction s;
   memset(&s, 0, sizeof(s));
@@ -139,18 +193,6 @@ static void install_signal_handler() {
   assert(ret == 0);
 }
 
-// setitimer() are inherited across fork(), should be called again from children
-void __am_init_timer_irq() {
-  _intr_write(0);
-
-  struct itimerval it = {};
-  it.it_value.tv_sec = 0;
-  it.it_value.tv_usec = 1000000 / TIMER_HZ;
-  it.it_interval = it.it_value;
-  int ret = setitimer(ITIMER_VIRTUAL, &it, NULL);
-  assert(ret == 0);
-}
-
 int _cte_init(_Context*(*handler)(_Event, _Context*)) {
   user_handler = handler;
 
@@ -170,6 +212,11 @@ _Context* _kcontext(_Area kstack, void (*entry)(void *), void *arg) {
   assert(ret == 0);
 
   c->vm_head = NULL;
+  c->fast = 1;
+  // fast_iret() loads these, but the kernel never fills __fpregs_mem in
+  // the example context, so start from the default control words
+  c->uc.__fpregs_mem.mxcsr = 0x1f80;
+  c->uc.__fpregs_mem.cwd = 0x37f;
 
   c->GPR1 = (uintptr_t)arg;
   c->GPR2 = (uintptr_t)entry;
@@ -177,7 +224,39 @@ _Context* _kcontext(_Area kstack, void (*entry)(void *), void *arg) {
 }
 
 void _yield() {
-  asm volatile (".byte " YIELD_INSTR);
+  // Yield in kernel does not need to go through the trap page, which costs
+  // two signals. Instead, save the callee-saved registers and call the
+  // handler directly. The context is resumed at label 1.
+  _Context c;
+  greg_t *gregs = c.uc.uc_mcontext.gregs;
+  asm volatile (
+    "lea 1f(%%rip), %%rax\n"
+    "mov %%rax, %c[rip](%[gregs])\n"
+    "mov %%rsp, %c[rsp](%[gregs])\n"
+    "mov %%rbx, %c[rbx](%[gregs])\n"
+    "mov %%rbp, %c[rbp](%[gregs])\n"
+    "mov %%r12, %c[r12](%[gregs])\n"
+    "mov %%r13, %c[r13](%[gregs])\n"
+    "mov %%r14, %c[r14](%[gregs])\n"
+    "mov %%r15, %c[r15](%[gregs])\n"
+    "stmxcsr %c[mxcsr](%[c])\n"
+    "fnstcw %c[fpucw](%[c])\n"
+    "mov %[c], %%rdi\n"
+    "sub $128, %%rsp\n"  // skip the red zone
+    "and $-16, %%rsp\n"
+    "call __am_fast_yield\n"
+    "1:"
+    : : [c] "r" (&c), [gregs] "r" (gregs),
+      [rip] "i" (REG_RIP * sizeof(greg_t)), [rsp] "i" (REG_RSP * sizeof(greg_t)),
+      [rbx] "i" (REG_RBX * sizeof(greg_t)), [rbp] "i" (REG_RBP * sizeof(greg_t)),
+      [r12] "i" (REG_R12 * sizeof(greg_t)), [r13] "i" (REG_R13 * sizeof(greg_t)),
+      [r14] "i" (REG_R14 * sizeof(greg_t)), [r15] "i" (REG_R15 * sizeof(greg_t)),
+      [mxcsr] "i" (offsetof(_Context, uc.__fpregs_mem.mxcsr)),
+      [fpucw] "i" (offsetof(_Context, uc.__fpregs_mem.cwd))
+    : "rax", "rcx", "rdx", "rsi", "rdi", "r8", "r9", "r10", "r11",
+      "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7",
+      "xmm8", "xmm9", "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15",
+      "cc", "memory");
 }
 
 int _intr_read() {
@@ -189,7 +268,7 @@ int _intr_read() {
 
 void _intr_write(int enable) {
   extern sigset_t __am_intr_sigmask;
-  // NOTE: sigprocmask does not supported in multithreading
+  // NOTE: on Linux sigprocmask() only changes the mask of the calling thread
   int ret = sigprocmask(enable ? SIG_UNBLOCK : SIG_BLOCK, &__am_intr_sigmask, NULL);
   assert(ret == 0);
 }
@@ -2,48 +2,18 @@
 #include <amdev.h>
 #include <SDL2/SDL.h>
 #include <klib.h>
+#include "../ringbuf.h"
 
 #define SBUF_SIZE_MAX 65536
 static uint8_t sbuf [SBUF_SIZE_MAX] = {};
-static int sbuf_size = 0;
-static int head = 0, tail = 0;
-static volatile int count = 0;
+// produced by the AM program, consumed by the SDL audio thread
+static RingBuf rb = {};
 
 static void audio_play(void *userdata, uint8_t *stream, int len) {
-  int nread = len;
-  if (count < len) nread = count;
-
-  if (nread + tail < sbuf_size) {
-    memcpy(stream, sbuf + tail, nread);
-    tail += nread;
-  } else {
-    int first_cpy_len = sbuf_size - tail;
-    memcpy(stream, sbuf + tail, first_cpy_len);
-    memcpy(stream + first_cpy_len, sbuf, nread - first_cpy_len);
-    tail = nread - first_cpy_len;
-  }
-  count -= nread;
+  int nread = rb_read(&rb, stream, len);
   if (len > nread) memset(stream + nread, 0, len - nread);
 }
 
-static int audio_write(uint8_t *buf, int len) {
-  int free = sbuf_size - count;
-  int nwrite = len;
-  if (free < len) nwrite = free;
-
-  if (nwrite + head < sbuf_size) {
-    memcpy(sbuf + head, buf, nwrite);
-    head += nwrite;
-  } else {
-    int first_cpy_len = sbuf_size - head;
-    memcpy(sbuf + head, buf, first_cpy_len);
-    memcpy(sbuf, buf + first_cpy_len, nwrite - first_cpy_len);
-    head = nwrite - first_cpy_len;
-  }
-  count += nwrite;
-  return nwrite;
-}
-
 void __am_audio_init() {
 }
 
@@ -58,11 +28,9 @@ size_t __am_audio_write(uintptr_t reg, void *buf, size_t size) {
       s.samples = init->samples;
       s.callback = audio_play;
       s.userdata = NULL;
-      sbuf_size = init->bufsize;
-      assert(sbuf_size <= SBUF_SIZE_MAX);
+      assert(init->bufsize <= SBUF_SIZE_MAX);
 
-      head = tail = 0;
-      count = 0;
+      rb_init(&rb, sbuf, init->bufsize);
       SDL_InitSubSystem(SDL_INIT_AUDIO);
       SDL_OpenAudio(&s, NULL);
       SDL_PauseAudio(0);
@@ -71,10 +39,11 @@ size_t __am_audio_write(uintptr_t reg, void *buf, size_t size) {
     case _DEVREG_AUDIO_SBCTRL: {
       _DEV_AUDIO_SBCTRL_t *ctl = (_DEV_AUDIO_SBCTRL_t *)buf;
       if (ctl->wait) {
-        assert(ctl->len <= sbuf_size);
-        while (sbuf_size - count < ctl->len);
+        assert(ctl->len <= rb.size);
+        // sleep instead of spinning until the audio thread frees enough space
+        rb_wait_space(&rb, ctl->len);
       }
-      ctl->len = audio_write(ctl->stream, ctl->len);
+      ctl->len = rb_write(&rb, ctl->stream, ctl->len);
       return size;
     }
   }
@@ -85,8 +54,8 @@ size_t __am_audio_read(uintptr_t reg, void *buf, size_t size) {
   switch (reg) {
     case _DEVREG_AUDIO_SBSTAT: {
       _DEV_AUDIO_SBSTAT_t *stat = (_DEV_AUDIO_SBSTAT_t *)buf;
-      stat->count = count;
-      stat->bufsize = sbuf_size;
+      stat->count = rb_count(&rb);
+      stat->bufsize = rb.size;
       return size;
     }
   }
@@ -1,13 +1,16 @@
 #include <amdev.h>
 #include <SDL2/SDL.h>
 #include "../platform.h"
+#include "../ringbuf.h"
 
 #define KEYDOWN_MASK 0x8000
 
 #define KEY_QUEUE_LEN 1024
 static int key_queue[KEY_QUEUE_LEN] = {};
-static int key_f = 0, key_r = 0;
-static SDL_mutex *key_queue_lock = NULL;
+// produced by the SDL event thread, consumed by the AM program
+static RingBuf key_rb = {};
+// the ring buffer has a single consumer, but several processors may read keys
+static volatile intptr_t key_reading = 0;
 
 #define XX(k) [SDL_SCANCODE_##k] = _KEY_##k,
 static int keymap[256] = {
@@ -28,11 +31,9 @@ static int event_thread(void *args) {
           int scancode = k.scancode;
           if (keymap[scancode] != 0) {
             int am_code = keymap[scancode] | (keydown ? KEYDOWN_MASK : 0);
-            SDL_LockMutex(key_queue_lock);
-            key_queue[key_r] = am_code;
-            key_r = (key_r + 1) % KEY_QUEUE_LEN;
-            SDL_UnlockMutex(key_queue_lock);
-            kill(getpid(), SIGUSR1);
+            if (rb_write(&key_rb, &am_code, sizeof(am_code)) == sizeof(am_code)) {
+              kill(getpid(), SIGUSR1);
+            }
           }
         }
         break;
@@ -41,7 +42,7 @@ static int event_thread(void *args) {
 }
 
 void __am_input_init() {
-  key_queue_lock = SDL_CreateMutex();
+  rb_init(&key_rb, (uint8_t *)key_queue, sizeof(key_queue));
   SDL_CreateThread(event_thread, "event thread", NULL);
 }
 
@@ -51,12 +52,13 @@ size_t __am_input_read(uintptr_t reg, void *buf, size_t size) {
       _DEV_INPUT_KBD_t *kbd = (_DEV_INPUT_KBD_t *)buf;
       int k = _KEY_NONE;
 
-      SDL_LockMutex(key_queue_lock);
-      if (key_f != key_r) {
-        k = key_queue[key_f];
-        key_f = (key_f + 1) % KEY_QUEUE_LEN;
+      // if another processor is reading, report no key instead of waiting
+      if (_atomic_xchg(&key_reading, 1) == 0) {
+        if (rb_count(&key_rb) >= sizeof(k)) {
+          rb_read(&key_rb, &k, sizeof(k));
+        }
+        _atomic_xchg(&key_reading, 0);
       }
-      SDL_UnlockMutex(key_queue_lock);
 
       kbd->keydown = (k & KEYDOWN_MASK ? 1 : 0);
       kbd->keycode = k & ~KEYDOWN_MASK;
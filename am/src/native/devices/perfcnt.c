@@ -0,0 +1,60 @@
+#include <am.h>
+#include <amdev.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+static const struct {
+  uint32_t valid;
+  uint64_t config;
+} events[] = {
+  { _PERFCNT_CYCLE,     PERF_COUNT_HW_CPU_CYCLES },
+  { _PERFCNT_INSTRET,   PERF_COUNT_HW_INSTRUCTIONS },
+  { _PERFCNT_CACHEMISS, PERF_COUNT_HW_CACHE_MISSES },
+  { _PERFCNT_BRMISS,    PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+#define NR_EVENTS (sizeof(events) / sizeof(events[0]))
+
+// perf events count the calling thread only, so each processor opens its own
+static __thread int fds[NR_EVENTS];
+static __thread uint32_t valid = 0;
+static __thread int opened = 0;
+
+static void open_events() {
+  for (int i = 0; i < NR_EVENTS; i ++) {
+    struct perf_event_attr attr = {};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = events[i].config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // may fail if the host has no PMU or perf_event_paranoid forbids it
+    fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fds[i] >= 0) valid |= events[i].valid;
+  }
+  opened = 1;
+}
+
+static uint64_t read_event(int i) {
+  uint64_t val = 0;
+  if (!(valid & events[i].valid)) return 0;
+  if (read(fds[i], &val, sizeof(val)) != sizeof(val)) return 0;
+  return val;
+}
+
+size_t __am_perfcnt_read(uintptr_t reg, void *buf, size_t size) {
+  switch (reg) {
+    case _DEVREG_PERFCNT_READ: {
+      _DEV_PERFCNT_READ_t *cnt = (_DEV_PERFCNT_READ_t *)buf;
+      if (!opened) open_events();
+      cnt->valid = valid;
+      cnt->cycle = read_event(0);
+      cnt->instret = read_event(1);
+      cnt->cachemiss = read_event(2);
+      cnt->brmiss = read_event(3);
+      return sizeof(_DEV_PERFCNT_READ_t);
+    }
+  }
+  return 0;
+}
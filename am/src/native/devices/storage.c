@@ -0,0 +1,77 @@
+#include <am.h>
+#include <amdev.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define BLKSZ 512
+
+// The disk image is given by the environment variable `disk`, and mapped
+// into the address space. Reads and writes are plain memory copies, and
+// writes are flushed to the image file asynchronously by Linux.
+static uint8_t *disk = NULL;
+static uint32_t blkcnt = 0;
+
+void __am_storage_init() {
+  const char *path = getenv("disk");
+  if (path == NULL) return;
+
+  int fd = open(path, O_RDWR);
+  if (fd == -1) {
+    printf("Can not open disk image %s\n", path);
+    return;
+  }
+  struct stat st;
+  int ret = fstat(fd, &st);
+  if (ret == 0 && st.st_size >= BLKSZ) {
+    void *p = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p != MAP_FAILED) {
+      disk = p;
+      blkcnt = st.st_size / BLKSZ;
+    }
+  }
+  // the mapping is still valid after closing the file
+  close(fd);
+}
+
+static int check_range(uint32_t blkno, uint32_t n) {
+  return disk != NULL && blkno <= blkcnt && n <= blkcnt - blkno;
+}
+
+size_t __am_storage_read(uintptr_t reg, void *buf, size_t size) {
+  switch (reg) {
+    case _DEVREG_STORAGE_INFO: {
+      _DEV_STORAGE_INFO_t *info = (_DEV_STORAGE_INFO_t *)buf;
+      info->blksz = BLKSZ;
+      info->blkcnt = blkcnt;
+      return sizeof(_DEV_STORAGE_INFO_t);
+    }
+    case _DEVREG_STORAGE_MAP: {
+      _DEV_STORAGE_MAP_t *map = (_DEV_STORAGE_MAP_t *)buf;
+      map->addr = disk;
+      return sizeof(_DEV_STORAGE_MAP_t);
+    }
+  }
+  return 0;
+}
+
+size_t __am_storage_write(uintptr_t reg, void *buf, size_t size) {
+  _DEV_STORAGE_RDCTRL_t *ctl = (_DEV_STORAGE_RDCTRL_t *)buf;
+  uint32_t blkno = ctl->blkno, n = ctl->blkcnt;
+  switch (reg) {
+    case _DEVREG_STORAGE_RDCTRL:
+      if (!check_range(blkno, n)) return 0;
+      // all blocks are transferred with a single copy
+      memcpy(ctl->buf, disk + (size_t)blkno * BLKSZ, (size_t)n * BLKSZ);
+      return sizeof(_DEV_STORAGE_RDCTRL_t);
+    case _DEVREG_STORAGE_WRCTRL:
+      if (!check_range(blkno, n)) return 0;
+      memcpy(disk + (size_t)blkno * BLKSZ, ctl->buf, (size_t)n * BLKSZ);
+      return sizeof(_DEV_STORAGE_WRCTRL_t);
+  }
+  return 0;
+}
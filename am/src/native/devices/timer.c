@@ -1,23 +1,40 @@
 #include <am.h>
 #include <amdev.h>
-#include <sys/time.h>
 #include <time.h>
 #include <unistd.h>
 
-static struct timeval boot_time = {};
+static struct timespec boot_time = {};
+
+static uint64_t uptime_ns() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - boot_time.tv_sec) * 1000000000ll + (now.tv_nsec - boot_time.tv_nsec);
+}
+
+static inline uint64_t rdtsc() {
+  uint32_t lo, hi;
+  asm volatile ("rdtsc": "=a"(lo), "=d"(hi));
+  return ((uint64_t)hi << 32) | lo;
+}
 
 size_t __am_timer_read(uintptr_t reg, void *buf, size_t size) {
   switch (reg) {
     case _DEVREG_TIMER_UPTIME: {
-      struct timeval now;
-      gettimeofday(&now, NULL);
-      long seconds = now.tv_sec - boot_time.tv_sec;
-      long useconds = now.tv_usec - boot_time.tv_usec;
       _DEV_TIMER_UPTIME_t *uptime = (_DEV_TIMER_UPTIME_t *)buf;
       uptime->hi = 0;
-      uptime->lo = seconds * 1000 + (useconds + 500) / 1000;
+      uptime->lo = (uptime_ns() + 500000) / 1000000;
       return sizeof(_DEV_TIMER_UPTIME_t);
     }
+    case _DEVREG_TIMER_USEC: {
+      _DEV_TIMER_USEC_t *usec = (_DEV_TIMER_USEC_t *)buf;
+      usec->us = uptime_ns() / 1000;
+      return sizeof(_DEV_TIMER_USEC_t);
+    }
+    case _DEVREG_TIMER_CYCLE: {
+      _DEV_TIMER_CYCLE_t *cycle = (_DEV_TIMER_CYCLE_t *)buf;
+      cycle->cycle = rdtsc();
+      return sizeof(_DEV_TIMER_CYCLE_t);
+    }
     case _DEVREG_TIMER_DATE: {
       time_t t = time(NULL);
       struct tm *tm = localtime(&t);
@@ -35,5 +52,5 @@ size_t __am_timer_read(uintptr_t reg, void *buf, size_t size) {
 }
 
 void __am_timer_init() {
-  gettimeofday(&boot_time, NULL);
+  clock_gettime(CLOCK_MONOTONIC, &boot_time);
 }
@@ -12,12 +12,47 @@ static SDL_Renderer *renderer = NULL;
 static SDL_Texture *texture = NULL;
 static uint32_t fb[W * H] = {};
 
+// bounding box of the region modified since the last texture_sync(),
+// empty if dirty.w == 0
+static SDL_Rect dirty = {};
+static SDL_SpinLock dirty_lock = 0;
+
 static inline int min(int x, int y) {
   return (x < y) ? x : y;
 }
 
+static inline int max(int x, int y) {
+  return (x > y) ? x : y;
+}
+
+static void mark_dirty(int x, int y, int w, int h) {
+  int x1 = min(x + w, W), y1 = min(y + h, H);
+  x = max(x, 0);
+  y = max(y, 0);
+  if (x >= x1 || y >= y1) return;
+
+  SDL_AtomicLock(&dirty_lock);
+  if (dirty.w == 0) {
+    dirty = (SDL_Rect) { .x = x, .y = y, .w = x1 - x, .h = y1 - y };
+  } else {
+    int dx1 = max(dirty.x + dirty.w, x1), dy1 = max(dirty.y + dirty.h, y1);
+    dirty.x = min(dirty.x, x);
+    dirty.y = min(dirty.y, y);
+    dirty.w = dx1 - dirty.x;
+    dirty.h = dy1 - dirty.y;
+  }
+  SDL_AtomicUnlock(&dirty_lock);
+}
+
 static Uint32 texture_sync(Uint32 interval, void *param) {
-  SDL_UpdateTexture(texture, NULL, fb, W * sizeof(Uint32));
+  SDL_AtomicLock(&dirty_lock);
+  SDL_Rect r = dirty;
+  dirty.w = 0;
+  SDL_AtomicUnlock(&dirty_lock);
+
+  // only upload the dirty region, and skip the frame if nothing changed
+  if (r.w == 0) return interval;
+  SDL_UpdateTexture(texture, &r, &fb[r.y * W + r.x], W * sizeof(Uint32));
   SDL_RenderClear(renderer);
   SDL_RenderCopy(renderer, texture, NULL, NULL);
   SDL_RenderPresent(renderer);
@@ -31,6 +66,7 @@ void __am_video_init() {
   texture = SDL_CreateTexture(renderer,
     SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, W, H);
   memset(fb, 0, W * H * sizeof(uint32_t));
+  mark_dirty(0, 0, W, H);
   SDL_AddTimer(1000 / FPS, texture_sync, NULL);
 }
 
@@ -42,6 +78,15 @@ size_t __am_video_read(uintptr_t reg, void *buf, size_t size) {
       info->height = H;
       return sizeof(_DEV_VIDEO_INFO_t);
     }
+    case _DEVREG_VIDEO_FBADDR: {
+      // applications draw into fb directly, and report
+      // the modified region by _DEVREG_VIDEO_PRESENT
+      _DEV_VIDEO_FBADDR_t *fbaddr = (_DEV_VIDEO_FBADDR_t *)buf;
+      fbaddr->pixels = fb;
+      fbaddr->width = W;
+      fbaddr->height = H;
+      return sizeof(_DEV_VIDEO_FBADDR_t);
+    }
   }
   return 0;
 }
@@ -57,11 +102,17 @@ size_t __am_video_write(uintptr_t reg, void *buf, size_t size) {
         memcpy(&fb[(y + j) * W + x], pixels, cp_bytes);
         pixels += w;
       }
+      mark_dirty(x, y, w, h);
       if (ctl->sync) {
         // do nothing, texture_sync() is called by SDL_timer
       }
       return size;
     }
+    case _DEVREG_VIDEO_PRESENT: {
+      _DEV_VIDEO_PRESENT_t *present = (_DEV_VIDEO_PRESENT_t *)buf;
+      mark_dirty(present->x, present->y, present->w, present->h);
+      return size;
+    }
   }
   return 0;
 }
@@ -1,16 +1,23 @@
 #include <stdatomic.h>
 #include "platform.h"
 
-int __am_mpe_init = 0;
+void __am_create_cpu_thread(void *(*fn)(void *), void *arg);
+
+static void (*mpe_entry)() = NULL;
+
+static void *cpu_thread(void *arg) {
+  __am_init_cpu((intptr_t)arg);
+  __am_init_timer_irq();
+  mpe_entry();
+  printf("MP entry should not return\n");
+  assert(0);
+  return NULL;
+}
 
 int _mpe_init(void (*entry)()) {
-  __am_mpe_init = 1;
+  mpe_entry = entry;
   for (int i = 1; i < _ncpu(); i++) {
-    if (fork() == 0) {
-      thiscpu->cpuid = i;
-      __am_init_timer_irq();
-      entry();
-    }
+    __am_create_cpu_thread(cpu_thread, (void *)(intptr_t)i);
   }
 
   entry();
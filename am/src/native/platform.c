@@ -1,7 +1,5 @@
 #define _GNU_SOURCE
 #include <sys/mman.h>
-#include <sys/auxv.h>
-#include <elf.h>
 #include <stdlib.h>
 #include "platform.h"
 
@@ -14,7 +12,7 @@ static void *pmem = NULL;
 static ucontext_t uc_example = {};
 static int sys_pgsz;
 sigset_t __am_intr_sigmask = {};
-__am_cpu_t *__am_cpu_struct = NULL;
+__thread __am_cpu_t *__am_cpu_struct = NULL;
 int __am_ncpu = 0;
 int __am_pgsize;
 
@@ -44,6 +42,7 @@ static void save_example_context() {
 }
 
 static void setup_sigaltstack() {
+  // the alternative signal stack is a per-thread attribute
   stack_t ss;
   ss.ss_sp = thiscpu->sigstack;
   ss.ss_size = sizeof(thiscpu->sigstack);
@@ -52,6 +51,17 @@ static void setup_sigaltstack() {
   assert(ret == 0);
 }
 
+// Each (virtual) processor is a thread sharing the whole address space.
+// Called by every processor before it runs any AM code.
+void __am_init_cpu(int cpuid) {
+  thiscpu = mmap(NULL, sizeof(*thiscpu), PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  assert(thiscpu != (void *)-1);
+  thiscpu->cpuid = cpuid;
+  thiscpu->vm_head = NULL;
+  setup_sigaltstack();
+}
+
 int main(const char *args);
 
 static void init_platform() __attribute__((constructor));
@@ -65,12 +75,8 @@ static void init_platform() {
       MAP_SHARED | MAP_FIXED, pmem_fd, 0);
   assert(pmem != (void *)-1);
 
-  // allocate private per-cpu structure
-  thiscpu = mmap(NULL, sizeof(*thiscpu), PROT_READ | PROT_WRITE,
-      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-  assert(thiscpu != (void *)-1);
-  thiscpu->cpuid = 0;
-  thiscpu->vm_head = NULL;
+  // set up the per-cpu structure of the boot processor
+  __am_init_cpu(0);
 
   // create trap page to receive syscall and yield by SIGSEGV
   sys_pgsz = sysconf(_SC_PAGESIZE);
@@ -78,47 +84,7 @@ static void init_platform() {
       MAP_SHARED | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
   assert(ret != (void *)-1);
 
-  // remap writable sections as MAP_SHARED
-  Elf64_Phdr *phdr = (void *)getauxval(AT_PHDR);
-  int phnum = (int)getauxval(AT_PHNUM);
-  int i;
   int ret2;
-  for (i = 0; i < phnum; i ++) {
-    if (phdr[i].p_type == PT_LOAD && (phdr[i].p_flags & PF_W)) {
-      // allocate temporary memory
-      extern char end;
-      void *vaddr = (void *)&end - phdr[i].p_memsz;
-      uintptr_t pad = (uintptr_t)vaddr & 0xfff;
-      void *vaddr_align = vaddr - pad;
-      uintptr_t size = phdr[i].p_memsz + pad;
-      void *temp_mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-      assert(temp_mem != (void *)-1);
-
-      // save data and bss sections
-      memcpy(temp_mem, vaddr_align, size);
-
-      // save the addresses of library functions which will be used after munamp()
-      // since calling the library functions requires accessing GOT, which will be unmapped
-      void *(*volatile mmap_libc)(void *, size_t, int, int, int, off_t) = &mmap;
-      void *(*volatile memcpy_libc)(void *, const void *, size_t) = &memcpy;
-
-      // unmap the data and bss sections
-      ret2 = munmap(vaddr_align, size);
-      assert(ret2 == 0);
-
-      // map the sections again with MAP_SHARED, which will be shared across fork()
-      ret = mmap_libc(vaddr_align, size, PROT_READ | PROT_WRITE | PROT_EXEC,
-          MAP_SHARED | MAP_FIXED | MAP_ANONYMOUS, -1, 0);
-      assert(ret == vaddr_align);
-
-      // restore the data in the sections
-      memcpy_libc(vaddr_align, temp_mem, size);
-
-      // unmap the temporary memory
-      ret2 = munmap(temp_mem, size);
-      assert(ret2 == 0);
-    }
-  }
 
   // set up the AM heap
   _heap = RANGE(pmem, pmem + PMEM_SIZE);
@@ -131,9 +97,6 @@ static void init_platform() {
   ret2 = sigaddset(&__am_intr_sigmask, SIGUSR1);
   assert(ret2 == 0);
 
-  // setup alternative signal stack
-  setup_sigaltstack();
-
   // save the context template
   save_example_context();
   __am_get_intr_sigmask(&uc_example.uc_sigmask);
@@ -156,26 +119,26 @@ static void init_platform() {
 }
 
 void __am_exit_platform(int code) {
-  // let Linux clean up other resource
-  extern int __am_mpe_init;
-  if (__am_mpe_init && _ncpu() > 1) kill(0, SIGKILL);
+  // exit() terminates all processor threads,
+  // and let Linux clean up other resource
   exit(code);
 }
 
-void __am_pmem_map(void *va, void *pa, int prot) {
+// map [va, va + len) to the physical memory [pa, pa + len)
+void __am_pmem_map(void *va, void *pa, size_t len, int prot) {
   // translate AM prot to mmap prot
   int mmap_prot = PROT_NONE;
   // we do not support executable bit, so mark
   // all readable pages executable as well
   if (prot & _PROT_READ) mmap_prot |= PROT_READ | PROT_EXEC;
   if (prot & _PROT_WRITE) mmap_prot |= PROT_WRITE;
-  void *ret = mmap(va, __am_pgsize, mmap_prot,
+  void *ret = mmap(va, len, mmap_prot,
       MAP_SHARED | MAP_FIXED, pmem_fd, (uintptr_t)(pa - pmem));
   assert(ret != (void *)-1);
 }
 
-void __am_pmem_unmap(void *va) {
-  int ret = munmap(va, __am_pgsize);
+void __am_pmem_unmap(void *va, size_t len) {
+  int ret = munmap(va, len);
   assert(ret == 0);
 }
 
@@ -11,8 +11,9 @@ void __am_get_example_uc(_Context *r);
 void __am_get_intr_sigmask(sigset_t *s);
 int __am_is_sigmask_sti(sigset_t *s);
 void __am_init_timer_irq();
-void __am_pmem_map(void *va, void *pa, int prot);
-void __am_pmem_unmap(void *va);
+void __am_pmem_map(void *va, void *pa, size_t len, int prot);
+void __am_pmem_unmap(void *va, size_t len);
+void __am_init_cpu(int cpuid);
 
 // per-cpu structure
 typedef struct {
@@ -22,7 +23,8 @@ typedef struct {
   _Event ev; // similar to cause register in mips/riscv
   uint8_t sigstack[SIGSTKSZ];
 } __am_cpu_t;
-extern __am_cpu_t *__am_cpu_struct;
+// each processor is a thread, so the per-cpu pointer lives in TLS
+extern __thread __am_cpu_t *__am_cpu_struct;
 #define thiscpu __am_cpu_struct
 
 #endif
@@ -0,0 +1,113 @@
+#ifndef __RINGBUF_H__
+#define __RINGBUF_H__
+
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+// Lock-free single-producer/single-consumer ring buffer of bytes.
+//
+// `head` is only written by the producer and `tail` only by the consumer.
+// Both run in [0, 2 * size) so that a full buffer can be told from an empty
+// one without requiring `size` to be a power of 2. The producer publishes data
+// with a release store to `head`, and the consumer frees space with a release
+// store to `tail`; the other side reads them with acquire loads.
+//
+// A producer can block until enough space is available. It sleeps on `tail`
+// with futex, and the consumer wakes it up after consuming data.
+
+typedef struct {
+  uint8_t *buf;
+  uint32_t size;
+  _Atomic uint32_t head;
+  _Atomic uint32_t tail;
+  _Atomic uint32_t waiting;
+} RingBuf;
+
+static inline void rb_init(RingBuf *rb, uint8_t *buf, uint32_t size) {
+  rb->buf = buf;
+  rb->size = size;
+  atomic_store(&rb->head, 0);
+  atomic_store(&rb->tail, 0);
+  atomic_store(&rb->waiting, 0);
+}
+
+static inline uint32_t rb_distance(RingBuf *rb, uint32_t head, uint32_t tail) {
+  return (head >= tail) ? head - tail : head + 2 * rb->size - tail;
+}
+
+static inline uint32_t rb_advance(RingBuf *rb, uint32_t pos, uint32_t n) {
+  pos += n;
+  return (pos >= 2 * rb->size) ? pos - 2 * rb->size : pos;
+}
+
+static inline uint32_t rb_index(RingBuf *rb, uint32_t pos) {
+  return (pos >= rb->size) ? pos - rb->size : pos;
+}
+
+// number of bytes available to the consumer, can be called from either side
+static inline uint32_t rb_count(RingBuf *rb) {
+  uint32_t head = atomic_load_explicit(&rb->head, memory_order_acquire);
+  uint32_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+  return rb_distance(rb, head, tail);
+}
+
+// copy [pos, pos + n) of the ring from/to a linear buffer, handling the wrap around
+static inline void rb_copy(RingBuf *rb, uint32_t pos, uint8_t *linear, uint32_t n, int to_ring) {
+  uint32_t idx = rb_index(rb, pos);
+  uint32_t first = (idx + n <= rb->size) ? n : rb->size - idx;
+  if (to_ring) {
+    memcpy(rb->buf + idx, linear, first);
+    memcpy(rb->buf, linear + first, n - first);
+  } else {
+    memcpy(linear, rb->buf + idx, first);
+    memcpy(linear + first, rb->buf, n - first);
+  }
+}
+
+// producer side: write at most `len` bytes, return the number of bytes written
+static inline uint32_t rb_write(RingBuf *rb, const void *data, uint32_t len) {
+  uint32_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+  uint32_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+  uint32_t free = rb->size - rb_distance(rb, head, tail);
+  if (len > free) len = free;
+  rb_copy(rb, head, (uint8_t *)data, len, 1);
+  atomic_store_explicit(&rb->head, rb_advance(rb, head, len), memory_order_release);
+  return len;
+}
+
+// consumer side: read at most `len` bytes, return the number of bytes read
+static inline uint32_t rb_read(RingBuf *rb, void *data, uint32_t len) {
+  uint32_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+  uint32_t head = atomic_load_explicit(&rb->head, memory_order_acquire);
+  uint32_t count = rb_distance(rb, head, tail);
+  if (len > count) len = count;
+  rb_copy(rb, tail, data, len, 0);
+  atomic_store_explicit(&rb->tail, rb_advance(rb, tail, len), memory_order_release);
+
+  // order the store to `tail` before the load of `waiting`, see rb_wait_space()
+  atomic_thread_fence(memory_order_seq_cst);
+  if (len > 0 && atomic_load_explicit(&rb->waiting, memory_order_relaxed)) {
+    syscall(SYS_futex, &rb->tail, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+  }
+  return len;
+}
+
+// producer side: sleep until at least `len` bytes of space are available
+static inline void rb_wait_space(RingBuf *rb, uint32_t len) {
+  while (1) {
+    uint32_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+    if (rb->size - rb_distance(rb, head, tail) >= len) return;
+
+    atomic_store_explicit(&rb->waiting, 1, memory_order_seq_cst);
+    // if the consumer has moved `tail` after we read it, the futex returns immediately
+    syscall(SYS_futex, &rb->tail, FUTEX_WAIT_PRIVATE, tail, NULL, NULL, 0);
+    atomic_store_explicit(&rb->waiting, 0, memory_order_relaxed);
+  }
+}
+
+#endif
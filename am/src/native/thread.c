@@ -0,0 +1,62 @@
+#define _GNU_SOURCE
+#include <am.h>
+#include <xsextra.h>
+#include <stdlib.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <assert.h>
+#include <sys/syscall.h>
+
+// Per-thread services for the processors in MPE.
+// This file does not include klib, whose time() conflicts with the one in libc.
+
+#define TIMER_HZ 100
+
+static __thread timer_t timer;
+
+static void timer_arm(uint64_t ns, int periodic) {
+  struct itimerspec it = {};
+  it.it_value.tv_sec = ns / 1000000000;
+  it.it_value.tv_nsec = ns % 1000000000;
+  if (periodic) it.it_interval = it.it_value;
+  // a zero it_value disarms the timer
+  int ret = timer_settime(timer, 0, &it, NULL);
+  assert(ret == 0);
+}
+
+void set_timer_hz(uint32_t hz) {
+  // clamp to 1ns, since a zero period would disarm the timer
+  if (hz > 1000000000) hz = 1000000000;
+  timer_arm(hz == 0 ? 0 : 1000000000ull / hz, 1);
+}
+
+void set_timer_oneshot(uint64_t us) {
+  timer_arm(us * 1000, 0);
+}
+
+// The timer measures the CPU time of the calling thread and delivers
+// SIGVTALRM to this thread only, so it should be called by every processor.
+// The initial frequency is given by the environment variable `hz`.
+void __am_init_timer_irq() {
+  _intr_write(0);
+
+  struct sigevent sev = {};
+  sev.sigev_notify = SIGEV_THREAD_ID;
+  sev.sigev_signo = SIGVTALRM;
+  sev._sigev_un._tid = syscall(SYS_gettid);
+  int ret = timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &timer);
+  assert(ret == 0);
+
+  const char *hz = getenv("hz");
+  set_timer_hz(hz ? atoi(hz) : TIMER_HZ);
+}
+
+void __am_create_cpu_thread(void *(*fn)(void *), void *arg) {
+  pthread_t tid;
+  int ret = pthread_create(&tid, NULL, fn, arg);
+  assert(ret == 0);
+  ret = pthread_detach(tid);
+  assert(ret == 0);
+}
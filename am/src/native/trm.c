@@ -12,7 +12,13 @@ void _putc(char ch) {
   fputc(ch, stderr);
 }
 
+void _putstr(const char *s, size_t len) {
+  // stderr is unbuffered, so this is a single write()
+  fwrite(s, 1, len, stderr);
+}
+
 void _halt(int code) {
+  if (__printf_flush) __printf_flush();
   printf("Exit (%d)\n", code);
   __am_exit_platform(code);
   printf("Should not reach here!\n");
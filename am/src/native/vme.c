@@ -2,32 +2,66 @@
 
 #define USER_SPACE RANGE(0x40000000, 0xc0000000)
 
-typedef struct PageMap {
-  void *va;
-  void *pa;
-  struct PageMap *next;
-  int prot;
-  int is_mapped;
-} PageMap;
+// The mappings of an address space are kept in a two-level table indexed
+// by the virtual page number, like a real page table. A directory entry
+// points to a table page, and a table entry holds (pa | prot | PTE_VALID).
+// Since the tables are ordered by va, contiguous runs of pages can be
+// mapped and unmapped with a single system call.
+#define PTE_VALID 0x100
 
-#define list_foreach(p, head) \
-  for (p = ((PageMap *)(head))->next; p != NULL; p = p->next)
+typedef uintptr_t PTE;
 
 extern int __am_pgsize;
 static int vme_enable = 0;
 static void* (*pgalloc)(size_t) = NULL;
 static void (*pgfree)(void *) = NULL;
+static int nr_pte;  // number of entries in a table page
+static int nr_dir;  // number of entries in the directory
+
+// The pmem mappings are shared by all processor threads, so the address
+// space they currently reflect is process-wide, not per-CPU. Hold the lock
+// with interrupts disabled, since __am_switch() runs in signal handlers.
+static PTE **mapped = NULL;
+static intptr_t mapped_lock = 0;
+
+static inline void mapped_acquire() {
+  while (_atomic_xchg(&mapped_lock, 1) != 0) ;
+  __sync_synchronize();
+}
+
+static inline void mapped_release() {
+  __sync_synchronize();
+  _atomic_xchg(&mapped_lock, 0);
+}
+
+static inline int vpn(void *va) {
+  return ((uintptr_t)va - (uintptr_t)USER_SPACE.start) / __am_pgsize;
+}
+
+static inline void *vpn2va(int vpn) {
+  return USER_SPACE.start + (uintptr_t)vpn * __am_pgsize;
+}
+
+static void *pgallocz(size_t size) {
+  void *p = pgalloc(size);
+  assert(p != NULL);
+  memset(p, 0, size);
+  return p;
+}
 
 int _vme_init(void* (*pgalloc_f)(size_t), void (*pgfree_f)(void*)) {
   pgalloc = pgalloc_f;
   pgfree = pgfree_f;
+  nr_pte = __am_pgsize / sizeof(PTE);
+  nr_dir = (vpn(USER_SPACE.end) + nr_pte - 1) / nr_pte;
   vme_enable = 1;
   return 0;
 }
 
 void _protect(_AddressSpace *as) {
   assert(as != NULL);
-  as->ptr = pgalloc(__am_pgsize); // used as head of the list
+  // the directory is also the key to describe an address space
+  as->ptr = pgallocz(ROUNDUP(nr_dir * sizeof(PTE *), __am_pgsize));
   as->pgsize = __am_pgsize;
   as->area = USER_SPACE;
 }
@@ -35,33 +69,75 @@ void _protect(_AddressSpace *as) {
 void _unprotect(_AddressSpace *as) {
 }
 
+// Pending runs of pages to unmap or map, flushed with one system call each.
+typedef struct {
+  int start, n;
+  PTE pte;  // the first entry of a map run
+} Run;
+
+static void flush_unmap(Run *r) {
+  if (r->n > 0) __am_pmem_unmap(vpn2va(r->start), (size_t)r->n * __am_pgsize);
+  r->n = 0;
+}
+
+static void flush_map(Run *r) {
+  if (r->n > 0) {
+    void *pa = (void *)(r->pte & ~(uintptr_t)(__am_pgsize - 1));
+    __am_pmem_map(vpn2va(r->start), pa, (size_t)r->n * __am_pgsize, r->pte & ~PTE_VALID & (__am_pgsize - 1));
+  }
+  r->n = 0;
+}
+
+static void add_unmap(Run *r, int vpn) {
+  if (r->n > 0 && r->start + r->n != vpn) flush_unmap(r);
+  if (r->n == 0) r->start = vpn;
+  r->n ++;
+}
+
+static void add_map(Run *r, int vpn, PTE pte) {
+  // a run needs contiguous va, contiguous pa and the same prot
+  if (r->n > 0 && (r->start + r->n != vpn || r->pte + (uintptr_t)r->n * __am_pgsize != pte)) {
+    flush_map(r);
+  }
+  if (r->n == 0) { r->start = vpn; r->pte = pte; }
+  r->n ++;
+}
+
 void __am_switch(_Context *c) {
   if (!vme_enable) return;
 
-  PageMap *head = c->vm_head;
-  if (head == thiscpu->vm_head) return;
-
-  PageMap *pp;
-  if (thiscpu->vm_head != NULL) {
-    // munmap all mappings
-    list_foreach(pp, thiscpu->vm_head) {
-      if (pp->is_mapped) {
-        __am_pmem_unmap(pp->va);
-        pp->is_mapped = false;
-      }
-    }
+  PTE **new = c->vm_head;
+  thiscpu->vm_head = new;
+
+  // called with interrupts disabled
+  mapped_acquire();
+  PTE **old = mapped;
+  if (new == old) {
+    mapped_release();
+    return;
   }
 
-  if (head != NULL) {
-    // mmap all mappings
-    list_foreach(pp, head) {
-      assert(IN_RANGE(pp->va, USER_SPACE));
-      __am_pmem_map(pp->va, pp->pa, pp->prot);
-      pp->is_mapped = true;
+  // only remap the pages whose mappings differ between the two spaces
+  Run unmap = { .n = 0 }, map = { .n = 0 };
+  for (int d = 0; d < nr_dir; d ++) {
+    PTE *opt = (old == NULL ? NULL : old[d]);
+    PTE *npt = (new == NULL ? NULL : new[d]);
+    if (opt == NULL && npt == NULL) continue;
+    for (int i = 0; i < nr_pte; i ++) {
+      int vpn = d * nr_pte + i;
+      PTE o = (opt == NULL ? 0 : opt[i]);
+      PTE n = (npt == NULL ? 0 : npt[i]);
+      if (o == n) continue;
+      // mmap() with MAP_FIXED replaces the old mapping, so no need to unmap it
+      if (n & PTE_VALID) add_map(&map, vpn, n);
+      else add_unmap(&unmap, vpn);
     }
   }
+  flush_unmap(&unmap);
+  flush_map(&map);
 
-  thiscpu->vm_head = head;
+  mapped = new;
+  mapped_release();
 }
 
 void _map(_AddressSpace *as, void *va, void *pa, int prot) {
@@ -69,30 +145,27 @@ void _map(_AddressSpace *as, void *va, void *pa, int prot) {
   assert((uintptr_t)va % __am_pgsize == 0);
   assert((uintptr_t)pa % __am_pgsize == 0);
   assert(as != NULL);
-  PageMap *pp = NULL;
-  PageMap *vm_head = as->ptr;
-  assert(vm_head != NULL);
-  list_foreach(pp, vm_head) {
-    if (pp->va == va) break;
-  }
+  PTE **dir = as->ptr;
+  assert(dir != NULL);
 
-  if (pp == NULL) {
-    pp = pgalloc(__am_pgsize); // this will waste memory, any better idea?
+  int n = vpn(va);
+  PTE *pt = dir[n / nr_pte];
+  if (pt == NULL) {
+    pt = dir[n / nr_pte] = pgallocz(__am_pgsize);
   }
-  pp->va = va;
-  pp->pa = pa;
-  pp->prot = prot;
-  pp->is_mapped = false;
-  // add after to vm_head to keep vm_head unchanged,
-  // since vm_head is a key to describe an address space
-  pp->next = vm_head->next;
-  vm_head->next = pp;
-
-  if (vm_head == thiscpu->vm_head) {
+  PTE pte = (uintptr_t)pa | prot | PTE_VALID;
+  if (pt[n % nr_pte] == pte) return;
+
+  int intr = _intr_read();
+  _intr_write(0);
+  mapped_acquire();
+  pt[n % nr_pte] = pte;
+  if (dir == mapped) {
     // enforce the map immediately
-    __am_pmem_map(pp->va, pp->pa, pp->prot);
-    pp->is_mapped = true;
+    __am_pmem_map(va, pa, __am_pgsize, prot);
   }
+  mapped_release();
+  if (intr) _intr_write(1);
 }
 
 _Context* _ucontext(_AddressSpace *as, _Area kstack, void *entry) {
@@ -105,6 +178,7 @@ _Context* _ucontext(_AddressSpace *as, _Area kstack, void *entry) {
   int ret = sigemptyset(&(c->uc.uc_sigmask)); // enable interrupt
   assert(ret == 0);
   c->vm_head = as->ptr;
+  c->fast = 0;
 
   c->ksp = (uintptr_t)kstack.end;
 
@@ -15,6 +15,17 @@ size_t __am_timer_read(uintptr_t reg, void *buf, size_t size) {
       uptime->lo = systime;
       return sizeof(_DEV_TIMER_UPTIME_t);
     }
+    case _DEVREG_TIMER_USEC: {
+      while (__am_event_thread());
+      _DEV_TIMER_USEC_t *usec = (_DEV_TIMER_USEC_t *)buf;
+      usec->us = (uint64_t)systime * 1000;
+      return sizeof(_DEV_TIMER_USEC_t);
+    }
+    case _DEVREG_TIMER_CYCLE: {
+      _DEV_TIMER_CYCLE_t *cycle = (_DEV_TIMER_CYCLE_t *)buf;
+      cycle->cycle = 0;
+      return sizeof(_DEV_TIMER_CYCLE_t);
+    }
     case _DEVREG_TIMER_DATE: {
       _DEV_TIMER_DATE_t *rtc = (_DEV_TIMER_DATE_t *)buf;
       rtc->second = 0;
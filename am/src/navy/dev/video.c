@@ -17,6 +17,13 @@ size_t __am_video_read(uintptr_t reg, void *buf, size_t size) {
       info->height = H;
       return sizeof(_DEV_VIDEO_INFO_t);
     }
+    case _DEVREG_VIDEO_FBADDR: {
+      _DEV_VIDEO_FBADDR_t *fbaddr = (_DEV_VIDEO_FBADDR_t *)buf;
+      fbaddr->pixels = NULL;
+      fbaddr->width = W;
+      fbaddr->height = H;
+      return sizeof(_DEV_VIDEO_FBADDR_t);
+    }
   }
   return 0;
 }
@@ -33,6 +40,10 @@ size_t __am_video_write(uintptr_t reg, void *buf, size_t size) {
       }
       return size;
     }
+    case _DEVREG_VIDEO_PRESENT: {
+      NDL_Render();
+      return size;
+    }
   }
   return 0;
 }
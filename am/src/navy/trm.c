@@ -15,6 +15,7 @@ void _putc(char ch) {
 }
 
 void _halt(int code) {
+  if (__printf_flush) __printf_flush();
   printf("Exit (%d)\n", code);
   exit(code);
 }
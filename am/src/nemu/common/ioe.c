@@ -4,14 +4,18 @@
 void __am_vga_init();
 void __am_timer_init();
 void __am_audio_init();
+void __am_perfcnt_init();
 
 int _ioe_init() {
   __am_vga_init();
   __am_timer_init();
   __am_audio_init();
+  __am_perfcnt_init();
   return 0;
 }
 
+// __am_perfcnt_read() is already taken by the riscv perf helpers
+size_t __am_perfcnt_dev_read(uintptr_t reg, void *buf, size_t size);
 size_t __am_timer_read(uintptr_t reg, void *buf, size_t size);
 size_t __am_video_read(uintptr_t reg, void *buf, size_t size);
 size_t __am_video_write(uintptr_t reg, void *buf, size_t size);
@@ -21,6 +25,7 @@ size_t __am_audio_write(uintptr_t reg, void *buf, size_t size);
 
 size_t _io_read(uint32_t dev, uintptr_t reg, void *buf, size_t size) {
   switch (dev) {
+    case _DEV_PERFCNT: return __am_perfcnt_dev_read(reg, buf, size);
     case _DEV_INPUT: return __am_input_read(reg, buf, size);
     case _DEV_TIMER: return __am_timer_read(reg, buf, size);
     case _DEV_VIDEO: return __am_video_read(reg, buf, size);
@@ -14,6 +14,13 @@ size_t __am_video_read(uintptr_t reg, void *buf, size_t size) {
       info->height = H;
       return sizeof(_DEV_VIDEO_INFO_t);
     }
+    case _DEVREG_VIDEO_FBADDR: {
+      _DEV_VIDEO_FBADDR_t *fbaddr = (_DEV_VIDEO_FBADDR_t *)buf;
+      fbaddr->pixels = fb;
+      fbaddr->width = W;
+      fbaddr->height = H;
+      return sizeof(_DEV_VIDEO_FBADDR_t);
+    }
   }
   return 0;
 }
@@ -41,6 +48,11 @@ size_t __am_video_write(uintptr_t reg, void *buf, size_t size) {
       }
       return size;
     }
+    case _DEVREG_VIDEO_PRESENT: {
+      // the whole screen is synchronized
+      outl(SYNC_ADDR, 0);
+      return size;
+    }
   }
   return 0;
 }
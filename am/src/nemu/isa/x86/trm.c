@@ -5,6 +5,9 @@ void _putc(char ch) {
 }
 
 void _halt(int code) {
+  if (__cxa_finalize) __cxa_finalize(NULL);
+  if (__printf_flush) __printf_flush();
+
   asm volatile (".byte 0xd6" : :"a"(code));
 
   // should not reach here
@@ -4,10 +4,27 @@
 #include <klib.h>
 
 static unsigned long boot_time = 0;
+static uint64_t boot_time64 = 0;
 static inline uint32_t read_time(void) {
   return ind(RTC_ADDR);  // unit: us
 }
 
+static inline uint64_t csr_read_mcycle(void) {
+#if __riscv_xlen == 32
+  uint32_t lo, hi, hi2;
+  do {
+    asm volatile("csrr %0, mcycleh" : "=r"(hi));
+    asm volatile("csrr %0, mcycle"  : "=r"(lo));
+    asm volatile("csrr %0, mcycleh" : "=r"(hi2));
+  } while (hi != hi2);
+  return ((uint64_t)hi << 32) | lo;
+#else
+  uint64_t cycle;
+  asm volatile("csrr %0, mcycle" : "=r"(cycle));
+  return cycle;
+#endif
+}
+
 size_t __am_timer_read(uintptr_t reg, void *buf, size_t size) {
   switch (reg) {
     case _DEVREG_TIMER_UPTIME: {
@@ -17,6 +34,16 @@ size_t __am_timer_read(uintptr_t reg, void *buf, size_t size) {
 //      printf("lo = %d\n", uptime->lo);
       return sizeof(_DEV_TIMER_UPTIME_t);
     }
+    case _DEVREG_TIMER_USEC: {
+      _DEV_TIMER_USEC_t *usec = (_DEV_TIMER_USEC_t *)buf;
+      usec->us = ind(RTC_ADDR) - boot_time64;
+      return sizeof(_DEV_TIMER_USEC_t);
+    }
+    case _DEVREG_TIMER_CYCLE: {
+      _DEV_TIMER_CYCLE_t *cycle = (_DEV_TIMER_CYCLE_t *)buf;
+      cycle->cycle = csr_read_mcycle();
+      return sizeof(_DEV_TIMER_CYCLE_t);
+    }
     case _DEVREG_TIMER_DATE: {
       _DEV_TIMER_DATE_t *rtc = (_DEV_TIMER_DATE_t *)buf;
       rtc->second = 0;
@@ -33,4 +60,5 @@ size_t __am_timer_read(uintptr_t reg, void *buf, size_t size) {
 
 void __am_timer_init() {
   boot_time = read_time();
+  boot_time64 = ind(RTC_ADDR);
 }
@@ -1,8 +1,86 @@
 #include <am.h>
+#include <amdev.h>
 #include <klib.h>
 
 #define PERFCNT_BASE 0xb00
 
+#define CSR_MCYCLE        0xb00
+#define CSR_MINSTRET      0xb02
+#define CSR_MHPMCOUNTER3  0xb03
+#define CSR_MHPMCOUNTER4  0xb04
+#define CSR_MHPMEVENT3    0x323
+#define CSR_MHPMEVENT4    0x324
+
+// Event selectors of the hardware performance monitors are implementation
+// defined. Pass them by CFLAGS, e.g. -DHPM_EVENT_CACHEMISS=<selector>,
+// to count cache misses and branch misses in mhpmcounter3 and mhpmcounter4.
+
+#if __riscv_xlen == 32
+// re-read if the low half carried into the high half between the reads
+#define READ_CSR64(csr) ({ \
+  uint32_t lo, hi, hi2; \
+  do { \
+    asm volatile("csrr %0, %1" : "=r"(hi) : "i"((csr) + 0x80)); \
+    asm volatile("csrr %0, %1" : "=r"(lo) : "i"(csr)); \
+    asm volatile("csrr %0, %1" : "=r"(hi2) : "i"((csr) + 0x80)); \
+  } while (hi != hi2); \
+  ((uint64_t)hi << 32) | lo; })
+#else
+#define READ_CSR64(csr) ({ \
+  uint64_t val; \
+  asm volatile("csrr %0, %1" : "=r"(val) : "i"(csr)); \
+  val; })
+#endif
+
+#if defined(HPM_EVENT_CACHEMISS) || defined(HPM_EVENT_BRMISS)
+#define NR_HART 64
+// the selectors are per-hart CSRs, and only one hart runs _ioe_init()
+static volatile char programmed[NR_HART];
+
+static void program_events() {
+#ifdef HPM_EVENT_CACHEMISS
+  asm volatile("csrw %0, %1" : : "i"(CSR_MHPMEVENT3), "r"(HPM_EVENT_CACHEMISS));
+#endif
+#ifdef HPM_EVENT_BRMISS
+  asm volatile("csrw %0, %1" : : "i"(CSR_MHPMEVENT4), "r"(HPM_EVENT_BRMISS));
+#endif
+  programmed[_cpu() % NR_HART] = 1;
+}
+#endif
+
+void __am_perfcnt_init() {
+#if defined(HPM_EVENT_CACHEMISS) || defined(HPM_EVENT_BRMISS)
+  program_events();
+#endif
+}
+
+size_t __am_perfcnt_dev_read(uintptr_t reg, void *buf, size_t size) {
+  switch (reg) {
+    case _DEVREG_PERFCNT_READ: {
+      _DEV_PERFCNT_READ_t *cnt = (_DEV_PERFCNT_READ_t *)buf;
+      cnt->valid = _PERFCNT_CYCLE | _PERFCNT_INSTRET;
+      cnt->cycle = READ_CSR64(CSR_MCYCLE);
+      cnt->instret = READ_CSR64(CSR_MINSTRET);
+      cnt->cachemiss = 0;
+      cnt->brmiss = 0;
+#if defined(HPM_EVENT_CACHEMISS) || defined(HPM_EVENT_BRMISS)
+      // other harts program their selectors on their first read
+      if (!programmed[_cpu() % NR_HART]) program_events();
+#endif
+#ifdef HPM_EVENT_CACHEMISS
+      cnt->cachemiss = READ_CSR64(CSR_MHPMCOUNTER3);
+      cnt->valid |= _PERFCNT_CACHEMISS;
+#endif
+#ifdef HPM_EVENT_BRMISS
+      cnt->brmiss = READ_CSR64(CSR_MHPMCOUNTER4);
+      cnt->valid |= _PERFCNT_BRMISS;
+#endif
+      return sizeof(_DEV_PERFCNT_READ_t);
+    }
+  }
+  return 0;
+}
+
 #define CNT_NAME(cnt) #cnt,
 static const char *name [] = {
   MAP(COUNTERS, CNT_NAME)
@@ -9,6 +9,7 @@ extern char _bss_start,  _bss_end;
 int main(const char *args);
 void __am_init_uartlite(void);
 void __am_uartlite_putchar(char ch);
+void __am_uartlite_putstr(const char *s, size_t len);
 
 _Area _heap = {
   .start = &_heap_start,
@@ -19,7 +20,14 @@ void _putc(char ch) {
   __am_uartlite_putchar(ch);
 }
 
+void _putstr(const char *s, size_t len) {
+  __am_uartlite_putstr(s, len);
+}
+
 void _halt(int code) {
+  if (__cxa_finalize) __cxa_finalize(NULL);
+  if (__printf_flush) __printf_flush();
+
   __asm__ volatile("mv a0, %0; .word 0x0005006b" : :"r"(code));
 
   // should not reach here during simulation
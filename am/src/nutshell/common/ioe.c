@@ -18,6 +18,7 @@ size_t __am_video_write(uintptr_t reg, void *buf, size_t size);
 size_t __am_input_read(uintptr_t reg, void *buf, size_t size);
 size_t __am_audio_read(uintptr_t reg, void *buf, size_t size);
 size_t __am_audio_write(uintptr_t reg, void *buf, size_t size);
+size_t __am_perfcnt_dev_read(uintptr_t reg, void *buf, size_t size);
 
 size_t _io_read(uint32_t dev, uintptr_t reg, void *buf, size_t size) {
   switch (dev) {
@@ -25,6 +26,7 @@ size_t _io_read(uint32_t dev, uintptr_t reg, void *buf, size_t size) {
     case _DEV_TIMER: return __am_timer_read(reg, buf, size);
     case _DEV_VIDEO: return __am_video_read(reg, buf, size);
     case _DEV_AUDIO: return __am_audio_read(reg, buf, size);
+    case _DEV_PERFCNT: return __am_perfcnt_dev_read(reg, buf, size);
   }
   return 0;
 }
@@ -4,6 +4,7 @@
 #include <klib.h>
 
 static unsigned long boot_time = 0;
+static uint64_t boot_time_us = 0;
 static inline uint32_t read_time(void) {
   return ind(RTC_ADDR) / 1000;  // unit: ms
 }
@@ -16,6 +17,18 @@ size_t __am_timer_read(uintptr_t reg, void *buf, size_t size) {
       uptime->lo = read_time() - boot_time;
       return sizeof(_DEV_TIMER_UPTIME_t);
     }
+    case _DEVREG_TIMER_USEC: {
+      _DEV_TIMER_USEC_t *usec = (_DEV_TIMER_USEC_t *)buf;
+      usec->us = ind(RTC_ADDR) - boot_time_us;
+      return sizeof(_DEV_TIMER_USEC_t);
+    }
+    case _DEVREG_TIMER_CYCLE: {
+      _DEV_TIMER_CYCLE_t *cycle = (_DEV_TIMER_CYCLE_t *)buf;
+      uint64_t mcycle;
+      asm volatile("csrr %0, mcycle" : "=r"(mcycle));
+      cycle->cycle = mcycle;
+      return sizeof(_DEV_TIMER_CYCLE_t);
+    }
     case _DEVREG_TIMER_DATE: {
       _DEV_TIMER_DATE_t *rtc = (_DEV_TIMER_DATE_t *)buf;
       rtc->second = 0;
@@ -31,5 +44,6 @@ size_t __am_timer_read(uintptr_t reg, void *buf, size_t size) {
 }
 
 void __am_timer_init() {
-  boot_time = read_time();
+  boot_time_us = ind(RTC_ADDR);
+  boot_time = boot_time_us / 1000;
 }
@@ -8,6 +8,8 @@
 
 #define UARTLITE_RST_FIFO 0x03
 #define UARTLITE_TX_FULL  0x08
+#define UARTLITE_TX_EMPTY 0x04
+#define UARTLITE_FIFO_DEPTH 16
 #define UARTLITE_RX_VALID 0x01
 
 void __am_init_uartlite(void) {
@@ -21,6 +23,25 @@ void __am_uartlite_putchar(char ch) {
   outb(UARTLITE_MMIO + UARTLITE_TX_FIFO, ch);
 }
 
+static inline void uartlite_burst_put(char ch, int *room) {
+  if (*room == 0) {
+    uint8_t stat;
+    while ((stat = inb(UARTLITE_MMIO + UARTLITE_STAT_REG)) & UARTLITE_TX_FULL);
+    // an empty FIFO takes a whole burst without polling again
+    *room = (stat & UARTLITE_TX_EMPTY) ? UARTLITE_FIFO_DEPTH : 1;
+  }
+  outb(UARTLITE_MMIO + UARTLITE_TX_FIFO, ch);
+  (*room) --;
+}
+
+void __am_uartlite_putstr(const char *s, size_t len) {
+  int room = 0;
+  while (len --) {
+    if (*s == '\n') uartlite_burst_put('\r', &room);
+    uartlite_burst_put(*s ++, &room);
+  }
+}
+
 int __am_uartlite_getchar() {
   if (inb(UARTLITE_MMIO + UARTLITE_STAT_REG) & UARTLITE_RX_VALID)
     return inb(UARTLITE_MMIO + UARTLITE_RX_FIFO);
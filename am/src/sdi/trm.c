@@ -19,6 +19,9 @@ void _putc(char ch) {
 }
 
 void _halt(int code) {
+  if (__cxa_finalize) __cxa_finalize(NULL);
+  if (__printf_flush) __printf_flush();
+
   printf("Exit with code = %d\n", code);
 
 #if defined(__ISA_X86__)
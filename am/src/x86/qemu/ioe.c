@@ -11,6 +11,7 @@ DEF_DEVOP(__am_input_read);
 DEF_DEVOP(__am_timer_read);
 DEF_DEVOP(__am_video_read);
 DEF_DEVOP(__am_video_write);
+DEF_DEVOP(__am_perfcnt_read);
 
 
 // AM INPUT (keyboard)
@@ -107,6 +108,7 @@ static void get_date(_DEV_TIMER_DATE_t *rtc) {
 
 void __am_timer_init() {
   freq_mhz = estimate_freq();
+  if (freq_mhz == 0) freq_mhz = 1; // TSC slower than 2^20 ticks/s, e.g. on slow TCG
   get_date(&boot_date);
   uptsc = rdtsc();
 }
@@ -122,6 +124,19 @@ size_t __am_timer_read(uintptr_t reg, void *buf, size_t size) {
       uptime->lo = ms;
       return sizeof(_DEV_TIMER_UPTIME_t);
     }
+    case _DEVREG_TIMER_USEC: {
+      _DEV_TIMER_USEC_t *usec = (_DEV_TIMER_USEC_t *)buf;
+      // us = tsc * 10^6 / (freq_mhz << 20), split to keep tsc * 10^6 from overflowing
+      uint64_t tsc = rdtsc() - uptsc;
+      uint64_t q = tsc / freq_mhz, r = tsc % freq_mhz;
+      usec->us = (q * 1000000 + r * 1000000 / freq_mhz) >> 20;
+      return sizeof(_DEV_TIMER_USEC_t);
+    }
+    case _DEVREG_TIMER_CYCLE: {
+      _DEV_TIMER_CYCLE_t *cycle = (_DEV_TIMER_CYCLE_t *)buf;
+      cycle->cycle = rdtsc();
+      return sizeof(_DEV_TIMER_CYCLE_t);
+    }
     case _DEVREG_TIMER_DATE: {
       get_date((_DEV_TIMER_DATE_t *)buf);
       return sizeof(_DEV_TIMER_DATE_t);
@@ -130,6 +145,68 @@ size_t __am_timer_read(uintptr_t reg, void *buf, size_t size) {
   return 0;
 }
 
+// AM PERFCNT (based on rdtsc and the architectural PMU)
+
+#define IA32_PERFEVTSEL0 0x186
+#define IA32_PMC0        0x0c1
+#define PERFEVT_USR      (1 << 16)
+#define PERFEVT_OS       (1 << 17)
+#define PERFEVT_EN       (1 << 22)
+
+static const struct {
+  uint32_t valid;
+  uint8_t event, umask;
+  int unavail_bit; // bit in cpuid.0ah:ebx, set if the event is not available
+} pmu_events[] = {
+  { _PERFCNT_INSTRET,   0xc0, 0x00, 1 },
+  { _PERFCNT_CACHEMISS, 0x2e, 0x41, 4 },
+  { _PERFCNT_BRMISS,    0xc5, 0x00, 6 },
+};
+
+static uint32_t pmu_valid[MAX_CPU];
+static int pmu_ready[MAX_CPU];
+
+// the PMU is per-cpu, program it on the first read from each processor
+static void pmu_init() {
+  uint32_t eax, ebx, ecx, edx, valid = 0;
+  cpuid(0, &eax, &ebx, &ecx, &edx);
+  if (eax >= 0xa) {
+    cpuid(0xa, &eax, &ebx, &ecx, &edx);
+    int version = eax & 0xff, nr_gp = (eax >> 8) & 0xff;
+    for (int i = 0; version > 0 && i < LENGTH(pmu_events) && i < nr_gp; i ++) {
+      if (ebx & (1 << pmu_events[i].unavail_bit)) continue;
+      wrmsr(IA32_PERFEVTSEL0 + i, 0);
+      wrmsr(IA32_PMC0 + i, 0);
+      wrmsr(IA32_PERFEVTSEL0 + i, pmu_events[i].event | (pmu_events[i].umask << 8) |
+          PERFEVT_USR | PERFEVT_OS | PERFEVT_EN);
+      valid |= pmu_events[i].valid;
+    }
+  }
+  pmu_valid[_cpu()] = valid;
+  pmu_ready[_cpu()] = 1;
+}
+
+size_t __am_perfcnt_read(uintptr_t reg, void *buf, size_t size) {
+  switch (reg) {
+    case _DEVREG_PERFCNT_READ: {
+      _DEV_PERFCNT_READ_t *cnt = (_DEV_PERFCNT_READ_t *)buf;
+      if (!pmu_ready[_cpu()]) pmu_init();
+      uint32_t valid = pmu_valid[_cpu()];
+      uint64_t val[LENGTH(pmu_events)] = {};
+      for (int i = 0; i < LENGTH(pmu_events); i ++) {
+        if (valid & pmu_events[i].valid) val[i] = rdmsr(IA32_PMC0 + i);
+      }
+      cnt->cycle = rdtsc();
+      cnt->instret = val[0];
+      cnt->cachemiss = val[1];
+      cnt->brmiss = val[2];
+      cnt->valid = valid | _PERFCNT_CYCLE;
+      return sizeof(_DEV_PERFCNT_READ_t);
+    }
+  }
+  return 0;
+}
+
 // AM VIDEO
 
 struct vbe_info {
@@ -167,6 +244,14 @@ size_t __am_video_read(uintptr_t reg, void *buf, size_t size) {
       info->height = H;
       return sizeof(_DEV_VIDEO_INFO_t);
     }
+    case _DEVREG_VIDEO_FBADDR: {
+      // the frame buffer is in 24-bit color, can not be accessed as 32-bit pixels
+      _DEV_VIDEO_FBADDR_t *fbaddr = (_DEV_VIDEO_FBADDR_t *)buf;
+      fbaddr->pixels = NULL;
+      fbaddr->width = W;
+      fbaddr->height = H;
+      return sizeof(_DEV_VIDEO_FBADDR_t);
+    }
   }
   return 0;
 }
@@ -189,6 +274,9 @@ size_t __am_video_write(uintptr_t reg, void *buf, size_t size) {
       }
       return sizeof(*ctl);
     }
+    case _DEVREG_VIDEO_PRESENT: {
+      return sizeof(_DEV_VIDEO_PRESENT_t);
+    }
   }
   return 0;
 }
@@ -246,6 +334,7 @@ size_t __am_storage_write(uintptr_t reg, void *buf, size_t size) {
 
 size_t _io_read(uint32_t dev, uintptr_t reg, void *buf, size_t size) {
   switch (dev) {
+    case _DEV_PERFCNT: return __am_perfcnt_read(reg, buf, size);
     case _DEV_INPUT:   return __am_input_read(reg, buf, size);
     case _DEV_TIMER:   return __am_timer_read(reg, buf, size);
     case _DEV_VIDEO:   return __am_video_read(reg, buf, size);
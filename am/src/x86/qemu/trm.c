@@ -39,6 +39,9 @@ void _putc(char ch) {
 }
 
 void _halt(int code) {
+  if (__cxa_finalize) __cxa_finalize(NULL);
+  if (__printf_flush) __printf_flush();
+
   const char *hex = "0123456789abcdef";
   const char *fmt = "CPU #$ Halt (40).\n";
   cli();
@@ -17,6 +17,7 @@ ClintInfo timer_handle;
 #define TIME_INC 0x800
 #endif
 #define CLINT_MTIMECMP (CLINT_MMIO + 0x4000)
+#define MTIME_FREQ 1000000 // mtime ticks in us
 
 /*
  * Note that timer interrupt is always triggered under machine mode
@@ -32,6 +33,42 @@ void set_timer_inc(uintptr_t inc) {
     timer_handle.time_inc = inc;
 }
 
+static inline uint64_t read_mtime() {
+    return *(volatile uint64_t *)(RTC_ADDR);
+}
+
+static inline void write_mtimecmp(uint64_t val) {
+    *(volatile uint64_t *)(timer_handle.mtimecmp) = val;
+}
+
+/*
+ * set the frequency of periodic timer interrupt
+ * hz = 0 stops the timer interrupt, hz above MTIME_FREQ is clamped to it
+ * should be called after init_timer()
+ */
+void set_timer_hz(uint32_t hz) {
+    // a zero inc would leave the timer one-shot
+    if (hz > MTIME_FREQ) hz = MTIME_FREQ;
+    if (hz == 0) {
+        set_timer_inc(0);
+        write_mtimecmp(-1ull);
+    } else {
+        set_timer_inc(MTIME_FREQ / hz);
+        write_mtimecmp(read_mtime() + MTIME_FREQ / hz);
+    }
+}
+
+/*
+ * tickless mode: raise a single timer interrupt after us microseconds
+ * us = 0 cancels the pending one
+ * the machine mode handler does not re-arm the timer when inc is 0
+ * should be called after init_timer()
+ */
+void set_timer_oneshot(uint64_t us) {
+    set_timer_inc(0);
+    write_mtimecmp(us == 0 ? -1ull : read_mtime() + us * MTIME_FREQ / 1000000);
+}
+
 /*
  * timer initialize
  * set interrupt handler
@@ -60,6 +60,14 @@ void disable_pmp(uintptr_t pmp_reg);
 void init_timer();
 void enable_timer();
 void set_timer_inc(uintptr_t inc);
+// The timer calls below affect the calling processor on native. On xs
+// there is one timer handler, which only programs the mtimecmp of hart 0.
+
+// periodic timer interrupts, 0 to stop them; clamped to the highest
+// supported rate (1MHz on xs, 1GHz on native)
+void set_timer_hz(uint32_t hz);
+// tickless mode: a single timer interrupt after `us` microseconds, 0 to cancel
+void set_timer_oneshot(uint64_t us);
 
 // =========== Interrupt handler registration =======
 void stip_handler_reg(_Context*(*handler)(_Event, _Context*));
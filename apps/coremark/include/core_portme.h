@@ -171,6 +171,7 @@ typedef struct CORE_PORTABLE_S {
 /* target specific init/fini */
 void portable_init(core_portable *p, int *argc, char *argv[]);
 void portable_fini(core_portable *p);
+void portable_report(ee_s16 total_errors, ee_u32 score);
 
 #if !defined(PROFILE_RUN) && !defined(PERFORMANCE_RUN) && !defined(VALIDATION_RUN)
 #if (TOTAL_DATA_SIZE==1200)
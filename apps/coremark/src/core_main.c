@@ -315,12 +315,12 @@ MAIN_RETURN_TYPE main(int argc, char *argv[]) {
 			ee_printf("[%d]crcstate      : 0x%04x\n",i,results[i].crcstate);
 	for (i=0 ; i<default_num_contexts; i++)
 		ee_printf("[%d]crcfinal      : 0x%04x\n",i,results[i].crc);
-  ee_printf("Finised in %d ms.\n", (int)total_time);
+  ee_printf("Finised in %d ms.\n", (int)time_in_secs(total_time));
+	ee_u32 score = (total_time == 0 ? 0 :
+	    (ee_u32)((uint64_t)default_num_contexts * ITERATIONS * 1000 * 1000 * 1000 / total_time));
 	if (total_errors==0) {
     ee_printf("==================================================\n");
-	  ee_printf("CoreMark Iterations/Sec %d\n", 
-        default_num_contexts * ITERATIONS * 1000 * 1000 / time_in_secs(total_time)
-      );
+	  ee_printf("CoreMark Iterations/Sec %d\n", score);
   }
 	if (total_errors>0)
 		ee_printf("Errors detected\n");
@@ -331,6 +331,7 @@ MAIN_RETURN_TYPE main(int argc, char *argv[]) {
 	for (i=0 ; i<MULTITHREAD; i++)
 		portable_free(results[i].memblock[0]);
 #endif
+	portable_report(total_errors, score);
 	/* And last call any target specific code for finalizing */
 	portable_fini(&(results[0].port));
 
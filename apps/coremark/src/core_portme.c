@@ -1,4 +1,5 @@
 #include "coremark.h"
+#include <benchkit.h>
 
 #if VALIDATION_RUN
 	volatile ee_s32 seed1_volatile=0x3415;
@@ -37,7 +38,7 @@
 #define EE_TICKS_PER_SEC (NSECS_PER_SEC / TIMER_RES_DIVIDER)
 
 /** Define Host specific (POSIX), or target specific global time variables. */
-unsigned long start_time_val, stop_time_val;
+static bk_time_t run_time;
 
 /* Function : start_time
 	This function will be called right before starting the timed portion of the benchmark.
@@ -46,7 +47,7 @@ unsigned long start_time_val, stop_time_val;
 	or zeroing some system parameters - e.g. setting the cpu clocks cycles to 0.
 */
 void start_time(void) {
-  start_time_val = uptime();
+  bk_timer_start(&run_time);
 }
 /* Function : stop_time
 	This function will be called right after ending the timed portion of the benchmark.
@@ -55,7 +56,7 @@ void start_time(void) {
 	or other system parameters - e.g. reading the current value of cpu cycles counter.
 */
 void stop_time(void) {
-  stop_time_val = uptime();
+  bk_timer_stop(&run_time);
 }
 /* Function : get_time
 	Return an abstract "ticks" number that signifies time on the system.
@@ -63,11 +64,10 @@ void stop_time(void) {
 	Actual value returned may be cpu cycles, milliseconds or any other value,
 	as long as it can be converted to seconds by <time_in_secs>.
 	This methodology is taken to accomodate any hardware or simulated platform.
-	The sample implementation returns millisecs by default,
-	and the resolution is controlled by <TIMER_RES_DIVIDER>
+	This implementation returns microseconds.
 */
 CORE_TICKS get_time(void) {
-  return stop_time_val - start_time_val;
+  return run_time.usec;
 }
 
 /* Function : time_in_secs
@@ -77,7 +77,8 @@ CORE_TICKS get_time(void) {
 	Default implementation implemented by the EE_TICKS_PER_SEC macro above.
 */
 secs_ret time_in_secs(CORE_TICKS ticks) {
-  return ticks;
+  // the result is reported in ms
+  return ticks / 1000;
 }
 
 ee_u32 default_num_contexts=1;
@@ -96,6 +97,21 @@ void portable_init(core_portable *p, int *argc, char *argv[])
 	}
 	p->portable_id=1;
 }
+/* Function : portable_report
+	Report the last timed run in the structured format of benchkit.
+*/
+void portable_report(ee_s16 total_errors, ee_u32 score)
+{
+	bk_result_t r;
+	bk_result_init(&r, "coremark", "coremark", NULL);
+	bk_result_time(&r, &run_time);
+	r.pass = (total_errors == 0);
+	if (r.pass) {
+		r.score = score;
+		r.unit = "Iterations/Sec";
+	}
+	bk_report(&r);
+}
 /* Function : portable_fini
 	Target specific final code
 */
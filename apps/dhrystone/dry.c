@@ -353,9 +353,10 @@
 #include <am.h>
 #include <klib.h>
 #include <klib-macros.h>
+#include <benchkit.h>
 
-#define Start_Timer() Begin_Time = uptime()
-#define Stop_Timer()  End_Time   = uptime()
+#define Start_Timer() bk_timer_start(&Run_Time)
+#define Stop_Timer()  bk_timer_stop(&Run_Time)
 
 #define NUMBER_OF_RUNS		500000 /* Default number of runs */
 #define PASS2
@@ -441,9 +442,8 @@ Enumeration     Func_1 ();
 
 Boolean		Done;
 
-long            Begin_Time,
-                End_Time,
-                User_Time;
+bk_time_t       Run_Time;
+long            User_Time;
 float           Microseconds,
                 Dhrystones_Per_Second;
 
@@ -847,7 +847,7 @@ int main ()
 
     Stop_Timer();
 
-    User_Time = End_Time - Begin_Time;
+    User_Time = Run_Time.usec / 1000;
 
     Done = true;
   }
@@ -937,12 +937,22 @@ int main ()
     printf("        should be:   DHRYSTONE PROGRAM, 2'ND STRING\n");
   }
 
+  uint32_t marks = (Run_Time.usec == 0 ? 0 :
+      (uint64_t)880900 * 1000 * NUMBER_OF_RUNS / 500000 / Run_Time.usec);
+
   printf ("Finished in %d ms\n", (int)User_Time);
   printf("==================================================\n");
-  printf("Dhrystone %s         %d Marks\n", pass ? "PASS" : "FAIL",
-      880900 / (int)User_Time * NUMBER_OF_RUNS/ 500000);
+  printf("Dhrystone %s         %d Marks\n", pass ? "PASS" : "FAIL", marks);
   printf("                   vs. 100000 Marks (i7-7700K @ 4.20GHz)\n");
 
+  bk_result_t r;
+  bk_result_init(&r, "dhrystone", "dhrystone", NULL);
+  bk_result_time(&r, &Run_Time);
+  r.pass = pass;
+  r.score = marks;
+  r.unit = "Marks";
+  bk_report(&r);
+
   return 0;
 }
 
@@ -126,16 +126,27 @@ BlitScreen(uint8 *XBuf)
 	// XXX soules - not entirely sure why this is being done yet
 	XBuf += s_srendline * 256;
 
+	int scrw = NWIDTH;
+
+#ifdef HAS_GUI
+  // if the frame buffer can be accessed directly, blit into it to skip a full-frame copy
+  uint32_t *fb = fb_addr();
+  int sw = screen_width(), sh = screen_height();
+  int x = (sw - 256) / 2, y = (sh - 240) / 2;
+  if (fb != NULL && x >= 0 && y >= 0) {
+    Blit8ToHigh(XBuf + NOFFSET, (uint8 *)&fb[y * sw + x], NWIDTH, s_tlines, sw * 4, 1, 1);
+    fb_present(x, y, scrw, s_tlines);
+    return;
+  }
+#endif
+
 	// XXX soules - again, I'm surprised SDL can't handle this
 	// perform the blit, converting bpp if necessary
   Blit8ToHigh(XBuf + NOFFSET, (uint8 *)canvas, NWIDTH, s_tlines, NWIDTH * 4, 1, 1);
 
-	int scrw = NWIDTH;
-
-
   // ensure that the display is updated
 #ifdef HAS_GUI
-  draw_rect(canvas, (screen_width() - 256) / 2, (screen_height() - 240) / 2, scrw, s_tlines);
+  draw_rect(canvas, x, y, scrw, s_tlines);
   draw_sync();
 #else
   printf("\033[0;0H");
@@ -4,6 +4,7 @@
 #include <am.h>
 #include <klib.h>
 #include <klib-macros.h>
+#include <benchkit.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -15,7 +16,21 @@ extern "C" {
 #define REF_CPU    "i7-7700K @ 4.20GHz"
 #define REF_SCORE  100000
 
+// Default number of timed runs and of untimed warmup runs of each
+// benchmark, which can be changed with the "repeat=" and "warmup=" options
 #define REPEAT  1
+#define WARMUP  0
+
+// Mutable global state of the benchmarks is declared BENCH_LOCAL. In the
+// multi-core mode every CPU runs its own instance of a benchmark, so this
+// state must be thread-local, which needs TLS set up for each CPU.
+#if defined(__ISA_NATIVE__) || defined(DUAL_CORE)
+#define BENCH_LOCAL __thread
+#define BENCH_HAS_MP 1
+#else
+#define BENCH_LOCAL
+#define BENCH_HAS_MP 0
+#endif
 
 //                  size |  heap | time |  checksum
 #define QSORT_S {     100,   1 KB,     0, 0x08467105}
@@ -61,12 +76,9 @@ extern "C" {
   def(ssort, "ssort", SSORT_S, SSORT_M, SSORT_L, "Suffix sort") \
   def(  md5,   "md5",   MD5_S,   MD5_M,   MD5_L, "MD5 digest") \
 
-// Each benchmark will run REPEAT times
+// Each benchmark will run WARMUP + REPEAT times
 
-#define DECL(_name, _sname, _s, _m, _l, _desc) \
-  void bench_##_name##_prepare(); \
-  void bench_##_name##_run(); \
-  int bench_##_name##_validate();
+#define DECL(_name, _sname, _s, _m, _l, _desc) BENCHKIT_DECL(_name, _sname, _desc)
 
 BENCHMARK_LIST(DECL)
 
@@ -77,19 +89,16 @@ typedef struct Setting {
 } Setting;
 
 typedef struct Benchmark {
-  void (*prepare)();
-  void (*run)();
-  int (*validate)();
-  const char *name, *desc;
+  bk_case_t bk;
   Setting settings[3];
 } Benchmark;
 
-extern Benchmark *current;
-extern Setting *setting;
+extern BENCH_LOCAL Benchmark *current;
+extern BENCH_LOCAL Setting *setting;
 
 typedef struct Result {
   int pass;
-  unsigned long tsc, msec;
+  bk_time_t time;
 } Result;
 
 void prepare(Result *res);
@@ -105,6 +114,7 @@ uint32_t bench_rand(); // return a random number between 0..32767
 
 // checksum
 uint32_t checksum(void *start, void *end);
+int check_checksum(uint32_t cs); // record the checksum of a run and compare it with the expected one
 
 #ifdef __cplusplus
 }
@@ -2,116 +2,128 @@
 #include <benchmark.h>
 #include <limits.h>
 #include <klib-macros.h>
+#ifdef DUAL_CORE
+#include <xsextra.h>
+#endif
 
-Benchmark *current;
-Setting *setting;
+BENCH_LOCAL Benchmark *current;
+BENCH_LOCAL Setting *setting;
 
-static char *hbrk;
+static BENCH_LOCAL char *hbrk;
+static BENCH_LOCAL _Area heap; // this CPU's slice of _heap
 
 // The benchmark list
 
 #define ENTRY(_name, _sname, _s, _m, _l, _desc) \
-  { .prepare = bench_##_name##_prepare, \
-    .run = bench_##_name##_run, \
-    .validate = bench_##_name##_validate, \
-    .name = _sname, \
-    .desc = _desc, \
+  { .bk = BENCHKIT_CASE(_name, _sname, _desc) \
     .settings = {_s, _m, _l}, },
 
 Benchmark benchmarks[] = {
   BENCHMARK_LIST(ENTRY)
 };
 
-// Running a benchmark
-static void bench_prepare(Result *res) {
-  res->msec = uptime();
-}
+#define MAX_CPU 64
 
-static void bench_reset() {
-  hbrk = (void *)ROUNDUP(_heap.start, 8);
-}
+static const char *setting_name;
+static char input[16]; // the input size in setting_name
+static int setting_id = -1;
+static bk_policy_t policy = { .warmup = WARMUP, .repeat = REPEAT };
+static Result mp_res[MAX_CPU]; // results of the concurrent runs
+static BENCH_LOCAL uint32_t last_checksum;
 
-static void bench_done(Result *res) {
-  res->msec = uptime() - res->msec;
+// Running a benchmark
+static void bench_reset() {
+  hbrk = (void *)ROUNDUP(heap.start, 8);
+  last_checksum = ~setting->checksum; // in case validate() does not compute it
 }
 
 static const char *bench_check(Benchmark *bench) {
-  uintptr_t freesp = (uintptr_t)_heap.end - (uintptr_t)_heap.start;
+  uintptr_t freesp = (uintptr_t)heap.end - (uintptr_t)heap.start;
   if (freesp < setting->mlim) {
     return "(insufficient memory)";
   }
   return NULL;
 }
 
-static void run_once(Benchmark *b, Result *res) {
-  bench_reset();       // reset malloc state
-  current->prepare();  // call bechmark's prepare function
-  bench_prepare(res);  // clean everything, start timer
-  current->run();      // run it
-  bench_done(res);     // collect results
-  res->pass = current->validate();
+// A single run for the multi-core mode. With `sync`, all CPUs start
+// timing together after their prepare().
+static void run_once(Result *res, int sync) {
+  bench_reset();
+  current->bk.prepare();
+  if (sync) sync_barrier();
+  bk_timer_start(&res->time);
+  current->bk.run();
+  bk_timer_stop(&res->time);
+  res->pass = current->bk.validate();
 }
 
-static unsigned long score(Benchmark *b, unsigned long tsc, unsigned long msec) {
-  if (msec == 0) return 0;
-  return (REF_SCORE / 1000) * setting->ref / msec;
+static unsigned long score(uint64_t usec) {
+  if (usec == 0) return 0;
+  return (uint64_t)REF_SCORE * setting->ref / usec;
 }
 
-int main(const char *args) {
-  const char *setting_name = args;
-  if (args == NULL || strcmp(args, "") == 0) {
-    printf("Empty mainargs. Use \"ref\" by default\n");
-    setting_name = "ref";
-  }
-  int setting_id = -1;
+static void select_bench(int i) {
+  current = &benchmarks[i];
+  setting = &current->settings[setting_id];
+}
 
-  if      (strcmp(setting_name, "test" ) == 0) setting_id = 0;
-  else if (strcmp(setting_name, "train") == 0) setting_id = 1;
-  else if (strcmp(setting_name, "ref"  ) == 0) setting_id = 2;
-  else {
-    printf("Invalid mainargs: \"%s\"; "
-           "must be in {test, train, ref}\n", setting_name);
-    _halt(1);
+static void print_summary(int pass, unsigned long bench_score, uint32_t t) {
+  printf("==================================================\n");
+  printf("MicroBench %s", pass ? "PASS" : "FAIL");
+  if (setting_id == 2) {
+    printf("        %d Marks\n", (unsigned int)bench_score);
+    printf("                   vs. %d Marks (%s)\n", REF_SCORE, REF_CPU);
+  } else {
+    printf("\n");
   }
+  printf("Total time: %d ms\n", t);
+}
 
-  _ioe_init();
-
-  printf("======= Running MicroBench [input *%s*] =======\n", setting_name);
+static void bench_single() {
+  heap = _heap;
+  policy.reset = bench_reset;
 
   unsigned long bench_score = 0;
   int pass = 1;
   uint32_t t0 = uptime();
 
   for (int i = 0; i < LENGTH(benchmarks); i ++) {
-    Benchmark *bench = &benchmarks[i];
-    current = bench;
-    setting = &bench->settings[setting_id];
+    select_bench(i);
+    Benchmark *bench = current;
     const char *msg = bench_check(bench);
-    printf("[%s] %s: ", bench->name, bench->desc);
+    printf("[%s] %s: ", bench->bk.name, bench->bk.desc);
     if (msg != NULL) {
       printf("Ignored %s\n", msg);
     } else {
-      unsigned long msec = ULONG_MAX;
-      int succ = 1;
-      for (int i = 0; i < REPEAT; i ++) {
-        Result res;
-        run_once(bench, &res);
-        printf(res.pass ? "*" : "X");
-        succ &= res.pass;
-        if (res.msec < msec) msec = res.msec;
-      }
+      bk_result_t r;
+      bk_result_init(&r, "microbench", bench->bk.name, input);
+      bk_run(&bench->bk, &policy, &r);
+      int succ = r.pass;
 
       if (succ) printf(" Passed.");
       else printf(" Failed.");
 
       pass &= succ;
 
-      unsigned long cur = score(bench, 0, msec);
+      bk_stat_t *st = &r.time;
+      unsigned long cur = score(st->min);
 
       printf("\n");
       if (setting_id != 0) {
-        printf("  min time: %d ms [%d]\n", (unsigned int)msec, (unsigned int)cur);
+        printf("  min time: %d ms [%d]\n", (unsigned int)(st->min / 1000), (unsigned int)cur);
+        if (policy.repeat > 1) {
+          printf("  min/median/mean/stddev: %d/%d/%d/%d us\n", (unsigned int)st->min,
+              (unsigned int)st->median, (unsigned int)st->mean, (unsigned int)st->stddev);
+        }
+      }
+      if (setting->ref != 0) {
+        r.score = cur;
+        r.unit = "Marks";
       }
+      r.has_checksum = 1;
+      r.checksum = last_checksum;
+      r.expected = setting->checksum;
+      bk_report(&r);
 
       bench_score += cur;
     }
@@ -120,16 +132,148 @@ int main(const char *args) {
 
   bench_score /= LENGTH(benchmarks);
 
-  printf("==================================================\n");
-  printf("MicroBench %s", pass ? "PASS" : "FAIL");
-  if (setting_id == 2) {
-    printf("        %d Marks\n", (unsigned int)bench_score);
-    printf("                   vs. %d Marks (%s)\n", REF_SCORE, REF_CPU);
-  } else {
-    printf("\n");
+  print_summary(pass, bench_score, t1 - t0);
+  _halt(!pass);
+}
+
+// Multi-core mode: every CPU runs its own instance of each benchmark in
+// its slice of the heap. The time of a benchmark on CPU 0 alone is the
+// baseline; all CPUs then run it together. The aggregate throughput is
+// n times the score of the slowest CPU, and the scaling efficiency is the
+// baseline time over the time of the slowest CPU.
+
+static void bench_mp() {
+  int cpu = _cpu(), n = _ncpu();
+  uintptr_t slice = ROUNDDOWN(((uintptr_t)_heap.end - (uintptr_t)_heap.start) / n, 8);
+  heap.start = (char *)_heap.start + cpu * slice;
+  heap.end = (char *)heap.start + slice;
+
+  unsigned long bench_score = 0, eff_sum = 0;
+  int pass = 1, nr_eff = 0;
+  uint32_t t0 = uptime();
+
+  for (int i = 0; i < LENGTH(benchmarks); i ++) {
+    select_bench(i);
+    Benchmark *bench = current;
+    const char *msg = bench_check(bench); // the same on every CPU
+    if (cpu == 0) printf("[%s] %s: ", bench->bk.name, bench->bk.desc);
+    if (msg != NULL) {
+      if (cpu == 0) printf("Ignored %s\n", msg);
+      continue;
+    }
+
+    Result base;
+    if (cpu == 0) run_once(&base, 0);
+    sync_barrier();
+    run_once(&mp_res[cpu], 1);
+    sync_barrier();
+
+    if (cpu == 0) {
+      int succ = base.pass;
+      uint64_t wall = 0;
+      for (int c = 0; c < n; c ++) {
+        succ &= mp_res[c].pass;
+        if (mp_res[c].time.usec > wall) wall = mp_res[c].time.usec;
+      }
+      printf(succ ? "* Passed.\n" : "X Failed.\n");
+      pass &= succ;
+
+      unsigned long cur = n * score(wall);
+      if (setting_id != 0) {
+        printf("  1 CPU: %d ms [%d]\n", (unsigned int)(base.time.usec / 1000), (unsigned int)score(base.time.usec));
+        printf("  %d CPUs:", n);
+        for (int c = 0; c < n; c ++) printf(" %d", (unsigned int)(mp_res[c].time.usec / 1000));
+        printf(" ms [%d]", (unsigned int)cur);
+        if (wall != 0 && base.time.usec != 0) {
+          unsigned long eff = base.time.usec * 100 / wall;
+          printf(", scaling efficiency %d%%", (unsigned int)eff);
+          eff_sum += eff;
+          nr_eff ++;
+        }
+        printf("\n");
+      }
+      bench_score += cur;
+    }
+    sync_barrier(); // CPU 0 is done with mp_res[]
   }
-  printf("Total time: %d ms\n", t1 - t0);
-  return !pass;
+  uint32_t t1 = uptime();
+
+  if (cpu == 0) {
+    bench_score /= LENGTH(benchmarks);
+    print_summary(pass, bench_score, t1 - t0);
+    if (nr_eff > 0) {
+      printf("%d CPUs, average scaling efficiency %d%%\n", n, (unsigned int)(eff_sum / nr_eff));
+    }
+    _halt(!pass);
+  }
+  while (1);
+}
+
+int main(const char *args) {
+  setting_name = args;
+  if (args == NULL || strcmp(args, "") == 0) {
+    printf("Empty mainargs. Use \"ref\" by default\n");
+    setting_name = "ref";
+  }
+
+  // mainargs: the input size, "-mp" after it for the multi-core mode,
+  // then the options separated by commas, e.g. "ref,repeat=5,warmup=1"
+  char buf[64];
+  strncpy(buf, setting_name, sizeof(buf) - 1);
+  buf[sizeof(buf) - 1] = '\0';
+  char *name = strtok(buf, ",");
+  if (name == NULL) name = "";
+  strncpy(input, name, sizeof(input) - 1);
+  char *suffix = strstr(input, "-mp");
+  int mp = (suffix != NULL && suffix[3] == '\0');
+  if (mp) *suffix = '\0';
+
+  int valid = 1;
+  if      (strcmp(input, "test" ) == 0) setting_id = 0;
+  else if (strcmp(input, "train") == 0) setting_id = 1;
+  else if (strcmp(input, "ref"  ) == 0) setting_id = 2;
+  else valid = 0;
+
+  int nr_opt = 0;
+  for (char *opt; (opt = strtok(NULL, ",")) != NULL; nr_opt ++) {
+    if (!bk_parse_option(&policy, opt)) valid = 0;
+  }
+
+  if (!valid) {
+    printf("Invalid mainargs: \"%s\"; "
+           "must be in {test, train, ref}, optionally followed by \"-mp\", "
+           "\",repeat=N\" (1 <= N <= %d) and \",warmup=N\"\n", setting_name, BK_MAX_REPEAT);
+    _halt(1);
+  }
+
+  if (mp && nr_opt > 0) {
+    // each benchmark runs exactly once per CPU in the multi-core mode
+    printf("\"repeat=N\" and \"warmup=N\" are not supported with \"-mp\"\n");
+    _halt(1);
+  }
+
+  if (!mp) {
+    _ioe_init();
+    printf("======= Running MicroBench [input *%s*] =======\n", setting_name);
+    bench_single();
+  }
+
+  if (!BENCH_HAS_MP) {
+    printf("The multi-core mode needs TLS, which is not supported on %s\n", TOSTRING(__ARCH__));
+    _halt(1);
+  }
+  assert(_ncpu() <= MAX_CPU);
+
+#ifdef DUAL_CORE
+  // the harts of xs-dual enter main() after being released
+  _mpe_setncpu('2');
+  if (_cpu() != 0) _mpe_init(bench_mp);
+  _mpe_wakeup(1);
+#endif
+  _ioe_init();
+  printf("======= Running MicroBench [input *%s*] on %d CPUs =======\n", setting_name, _ncpu());
+  _mpe_init(bench_mp);
+  return 0;
 }
 
 // Libraries
@@ -138,18 +282,18 @@ void* bench_alloc(size_t size) {
   size  = (size_t)ROUNDUP(size, 8);
   char *old = hbrk;
   hbrk += size;
-  assert((uintptr_t)_heap.start <= (uintptr_t)hbrk && (uintptr_t)hbrk < (uintptr_t)_heap.end);
+  assert((uintptr_t)heap.start <= (uintptr_t)hbrk && (uintptr_t)hbrk < (uintptr_t)heap.end);
   for (uint64_t *p = (uint64_t *)old; p != (uint64_t *)hbrk; p ++) {
     *p = 0;
   }
-  assert((uintptr_t)hbrk - (uintptr_t)_heap.start <= setting->mlim);
+  assert((uintptr_t)hbrk - (uintptr_t)heap.start <= setting->mlim);
   return old;
 }
 
 void bench_free(void *ptr) {
 }
 
-static uint32_t seed = 1;
+static BENCH_LOCAL uint32_t seed = 1;
 
 void bench_srand(uint32_t _seed) {
   seed = _seed & 0x7fff;
@@ -160,6 +304,11 @@ uint32_t bench_rand() {
   return (seed >> 16) & 0x7fff;
 }
 
+int check_checksum(uint32_t cs) {
+  last_checksum = cs;
+  return cs == setting->checksum;
+}
+
 // FNV hash
 uint32_t checksum(void *start, void *end) {
   const uint32_t x = 16777619;
@@ -23,7 +23,7 @@
 
 #include <benchmark.h>
 
-static int ARR_SIZE;
+static BENCH_LOCAL int ARR_SIZE;
 
 #define CODE            ">>+>>>>>,[>+>>,]>+[--[+<<<-]<[<+>-]<[<[->[<<<+>>>>+<-]<<[>>+>[->]<<[<]" \
                         "<-]>]>>>+<[[-]<[>+<-]<]>[[>>>]+<<<-<[<<[<<<]>>+>[>>>]<-]<<[<<<]>[>>[>>" \
@@ -56,11 +56,11 @@ struct instruction_t {
   unsigned short operand;
 };
 
-static struct instruction_t *PROGRAM;
-static unsigned short *STACK;
-static unsigned int SP;
-static const char *code;
-static char *input;
+static BENCH_LOCAL struct instruction_t *PROGRAM;
+static BENCH_LOCAL unsigned short *STACK;
+static BENCH_LOCAL unsigned int SP;
+static BENCH_LOCAL const char *code;
+static BENCH_LOCAL char *input;
 
 static int compile_bf() {
   unsigned short pc = 0, jmp_pc;
@@ -101,9 +101,9 @@ static int compile_bf() {
   return SUCCESS;
 }
 
-static unsigned short *data;
-static char *output;
-static int noutput;
+static BENCH_LOCAL unsigned short *data;
+static BENCH_LOCAL char *output;
+static BENCH_LOCAL int noutput;
 
 static void execute_bf() {
   unsigned int pc = 0, ptr = 0;
@@ -147,5 +147,5 @@ void bench_bf_run() {
 
 int bench_bf_validate() {
   uint32_t cs = checksum(output, output + noutput);
-  return noutput == ARR_SIZE && cs == setting->checksum;
+  return check_checksum(cs) && noutput == ARR_SIZE;
 }
@@ -1,6 +1,6 @@
 #include <benchmark.h>
 
-static int N;
+static BENCH_LOCAL int N;
 const int INF = 0x3f3f3f;
 
 struct Edge {
@@ -106,8 +106,8 @@ struct Dinic {
 extern "C" {
 
 
-static Dinic *G;
-static int ans;
+static BENCH_LOCAL Dinic *G;
+static BENCH_LOCAL int ans;
 
 void bench_dinic_prepare() {
   N = setting->size;
@@ -131,7 +131,7 @@ void bench_dinic_run() {
 }
 
 int bench_dinic_validate() {
-  return (uint32_t)ans == setting->checksum;
+  return check_checksum((uint32_t)ans);
 }
 }
 
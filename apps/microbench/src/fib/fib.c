@@ -3,7 +3,7 @@
 // f(n) = (f(n-1) + f(n-2) + .. f(n-m)) mod 2^32
 
 #define N 2147483603
-static int M;
+static BENCH_LOCAL int M;
 
 static void put(uint32_t *m, int i, int j, uint32_t data) {
   m[i * M + j] = data;
@@ -29,7 +29,7 @@ static inline void assign(uint32_t *a, uint32_t *b) {
       put(a, i, j, get(b, i, j));
 }
 
-static uint32_t *A, *ans, *T, *tmp;
+static BENCH_LOCAL uint32_t *A, *ans, *T, *tmp;
 
 void bench_fib_prepare() {
   M = setting->size;
@@ -60,5 +60,5 @@ void bench_fib_run() {
 }
 
 int bench_fib_validate() {
-  return get(ans, M-1, M-1) == setting->checksum;
+  return check_checksum(get(ans, M-1, M-1));
 }
@@ -1,12 +1,12 @@
 #include "quicklz.h"
 #include <benchmark.h>
 
-static int SIZE;
+static BENCH_LOCAL int SIZE;
 
-static qlz_state_compress *state;
-static char *blk;
-static char *compress;
-static int len;
+static BENCH_LOCAL qlz_state_compress *state;
+static BENCH_LOCAL char *blk;
+static BENCH_LOCAL char *compress;
+static BENCH_LOCAL int len;
 
 void bench_lzip_prepare() {
   SIZE = setting->size;
@@ -24,6 +24,6 @@ void bench_lzip_run() {
 }
 
 int bench_lzip_validate() {
-  return checksum(compress, compress + len) == setting->checksum;
+  return check_checksum(checksum(compress, compress + len));
 }
 
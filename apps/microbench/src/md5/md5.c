@@ -5,7 +5,7 @@
 
 #include <benchmark.h>
 
-static int N;
+static BENCH_LOCAL int N;
 
 // Constants are the integer part of the sines of integers (in radians) * 2^32.
 const uint32_t k[64] = {
@@ -137,8 +137,8 @@ static void md5(uint8_t *msg, size_t initial_len, uint8_t *digest) {
     to_bytes(h3, digest + 12);
 }
 
-static uint8_t *str;
-static uint8_t *digest;
+static BENCH_LOCAL uint8_t *str;
+static BENCH_LOCAL uint8_t *digest;
 
 void bench_md5_prepare() {
   N = setting->size;
@@ -155,5 +155,5 @@ void bench_md5_run() {
 }
 
 int bench_md5_validate() {
-  return checksum(digest, digest + 16) == setting->checksum;
+  return check_checksum(checksum(digest, digest + 16));
 }
@@ -1,6 +1,6 @@
 #include <benchmark.h>
 
-static int N, *data;
+static BENCH_LOCAL int N, *data;
 
 void bench_qsort_prepare() {
   bench_srand(1);
@@ -40,5 +40,5 @@ void bench_qsort_run() {
 }
 
 int bench_qsort_validate() {
-  return checksum(data, data + N) == setting->checksum;
+  return check_checksum(checksum(data, data + N));
 }
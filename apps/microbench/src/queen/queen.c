@@ -1,6 +1,6 @@
 #include <benchmark.h>
 
-static unsigned int FULL;
+static BENCH_LOCAL unsigned int FULL;
 
 static unsigned int dfs(unsigned int row, unsigned int ld, unsigned int rd) {
   if (row == FULL) {
@@ -16,7 +16,7 @@ static unsigned int dfs(unsigned int row, unsigned int ld, unsigned int rd) {
   }
 }
 
-static unsigned int ans;
+static BENCH_LOCAL unsigned int ans;
 
 void bench_queen_prepare() {
   ans = 0;
@@ -28,5 +28,5 @@ void bench_queen_run() {
 }
 
 int bench_queen_validate() {
-  return ans == setting->checksum;
+  return check_checksum(ans);
 }
@@ -1,9 +1,9 @@
 #include <benchmark.h>
 
-static int N;
+static BENCH_LOCAL int N;
 
-static int ans;
-static uint32_t *primes;
+static BENCH_LOCAL int ans;
+static BENCH_LOCAL uint32_t *primes;
 
 static inline int get(int n) {
   return (primes[n >> 5] >> (n & 31)) & 1;
@@ -38,5 +38,5 @@ void bench_sieve_run() {
 }
 
 int bench_sieve_validate() {
-  return ans == setting->checksum;
+  return check_checksum(ans);
 }
@@ -2,7 +2,7 @@
 
 #include <benchmark.h>
 
-static int N;
+static BENCH_LOCAL int N;
 
 inline bool leq(int a1, int a2,   int b1, int b2) { // lexic. order for pairs
   return(a1 < b1 || (a1 == b1 && a2 <= b2));
@@ -86,7 +86,7 @@ void suffixArray(int* s, int* SA, int n, int K) {
 
 extern "C" {
 
-static int *s, *sa;
+static BENCH_LOCAL int *s, *sa;
 
 void bench_ssort_prepare() {
   N = setting->size;
@@ -104,7 +104,7 @@ void bench_ssort_run() {
 }
 
 int bench_ssort_validate() {
-  return checksum(sa, sa + N) == setting->checksum;
+  return check_checksum(checksum(sa, sa + N));
 }
 
 }
@@ -41,6 +41,11 @@
 /*  5. Absolutely no warranty is expressed or implied.                   */
 /*-----------------------------------------------------------------------*/
 # include <klib.h>
+# include <klib-macros.h>
+# include <benchkit.h>
+#ifdef DUAL_CORE
+# include <xsextra.h>
+#endif
 
 /*-----------------------------------------------------------------------
  * INSTRUCTIONS:
@@ -74,7 +79,7 @@
  *          size of L3 caches.  The new default size is large enough for caches
  *          up to 20 MB. 
  *      Version 5.10 changes the loop index variables from "register int"
- *          to "ssize_t", which allows array indices >2^32 (4 billion)
+ *          to "long", which allows array indices >2^32 (4 billion)
  *          on properly configured 64-bit systems.  Additional compiler options
  *          (such as "-mcmodel=medium") may be required for large memory runs.
  *
@@ -129,12 +134,10 @@
  *            cc -O stream.c -o stream
  *     This is known to work on many, many systems....
  *
- *     To use multiple cores, you need to tell the compiler to obey the OpenMP
- *       directives in the code.  This varies by compiler, but a common example is
- *            gcc -O -fopenmp stream.c -o stream_omp
- *       The environment variable OMP_NUM_THREADS allows runtime control of the 
- *         number of threads/cores used when the resulting "stream_omp" program
- *         is executed.
+ *     There is no OpenMP in AM. To use multiple cores, this port runs the
+ *       kernels on all the CPUs started by _mpe_init() instead, each of them
+ *       on its own slice of the arrays (see below). The number of CPUs is
+ *       the _ncpu() of the platform, e.g. "make run ARCH=native smp=4".
  *
  *     To run with single-precision variables and arithmetic, simply add
  *         -DSTREAM_TYPE=float
@@ -142,9 +145,10 @@
  *     Note that this changes the minimum array sizes required --- see (1) above.
  *
  *     The preprocessor directive "TUNED" does not do much -- it simply causes the 
- *       code to call separate functions to execute each kernel.  Trivial versions
- *       of these functions are provided, but they are *not* tuned -- they just 
- *       provide predefined interfaces to be replaced with tuned code.
+ *       code to call separate functions to execute each kernel.  In this port,
+ *       the functions are in tuned.c, and are selected with "make STREAM_KERNEL=..."
+ *       (unrolled, SSE2, AVX, RISC-V Vector or non-temporal stores), which
+ *       defines TUNED.  See the README.
  *
  *
  *	4) Optional: Mail the results to mccalpin@cs.virginia.edu
@@ -171,9 +175,27 @@
 #define STREAM_TYPE double
 #endif
 
-static STREAM_TYPE	a[STREAM_ARRAY_SIZE+OFFSET],
-			b[STREAM_ARRAY_SIZE+OFFSET],
-			c[STREAM_ARRAY_SIZE+OFFSET];
+#ifndef STREAM_KERNEL
+#define STREAM_KERNEL "scalar"
+#endif
+
+/*  In the AM port, the arrays are not static. Each CPU owns a contiguous
+ *      slice of a[], b[] and c[], which is placed in its own part of the
+ *      heap and initialized by itself, so that the memory is local to it
+ *      on NUMA systems. The kernels run on all CPUs at the same time: the
+ *      CPUs meet at a barrier before each kernel, and the time of a kernel
+ *      is the time of the slowest CPU.
+ */
+#define MAX_CPU 64
+
+typedef struct {
+    STREAM_TYPE		*a, *b, *c;
+    long		n;			/* elements of each array */
+    double		times[4][NTIMES];	/* in seconds */
+    _DEV_PERFCNT_READ_t	perf[4];		/* of the fastest iteration */
+} __attribute__((aligned(64))) slice_t;
+
+static slice_t		slice[MAX_CPU];
 
 #define FLT_MAX 1E+37
 static double	avgtime[4] = {0}, maxtime[4] = {0},
@@ -181,6 +203,7 @@ static double	avgtime[4] = {0}, maxtime[4] = {0},
 
 static char	*label[4] = {"Copy:      ", "Scale:     ",
     "Add:       ", "Triad:     "};
+static char	*name[4] = {"copy", "scale", "add", "triad"};
 
 static double	bytes[4] = {
     2 * sizeof(STREAM_TYPE) * STREAM_ARRAY_SIZE,
@@ -190,34 +213,122 @@ static double	bytes[4] = {
     };
 
 extern double mysecond();
-extern void checkSTREAMresults();
+extern int checkSTREAMresults();
 #ifdef TUNED
-extern void tuned_STREAM_Copy();
-extern void tuned_STREAM_Scale(STREAM_TYPE scalar);
-extern void tuned_STREAM_Add();
-extern void tuned_STREAM_Triad(STREAM_TYPE scalar);
+extern void tuned_STREAM_Init();
+extern void tuned_STREAM_Copy(STREAM_TYPE *c, const STREAM_TYPE *a, long n);
+extern void tuned_STREAM_Scale(STREAM_TYPE *b, const STREAM_TYPE *c, STREAM_TYPE scalar, long n);
+extern void tuned_STREAM_Add(STREAM_TYPE *c, const STREAM_TYPE *a, const STREAM_TYPE *b, long n);
+extern void tuned_STREAM_Triad(STREAM_TYPE *a, const STREAM_TYPE *b, const STREAM_TYPE *c, STREAM_TYPE scalar, long n);
 #endif
-#ifdef _OPENMP
-extern int omp_get_num_threads();
+
+static void
+run_kernel(int k, slice_t *s, STREAM_TYPE scalar)
+    {
+    STREAM_TYPE		*a = s->a, *b = s->b, *c = s->c;
+    long		n = s->n;
+#ifndef TUNED
+    long		j;
 #endif
-int
-main()
+
+    switch (k) {
+    case 0:
+#ifdef TUNED
+	tuned_STREAM_Copy(c, a, n);
+#else
+	for (j=0; j<n; j++)
+	    c[j] = a[j];
+#endif
+	break;
+    case 1:
+#ifdef TUNED
+	tuned_STREAM_Scale(b, c, scalar, n);
+#else
+	for (j=0; j<n; j++)
+	    b[j] = scalar*c[j];
+#endif
+	break;
+    case 2:
+#ifdef TUNED
+	tuned_STREAM_Add(c, a, b, n);
+#else
+	for (j=0; j<n; j++)
+	    c[j] = a[j]+b[j];
+#endif
+	break;
+    case 3:
+#ifdef TUNED
+	tuned_STREAM_Triad(a, b, c, scalar, n);
+#else
+	for (j=0; j<n; j++)
+	    a[j] = b[j]+scalar*c[j];
+#endif
+	break;
+    }
+    }
+
+static void
+report(const char *bench, double *times, double nbytes, int err, _DEV_PERFCNT_READ_t *perf)
     {
-    int			quantum, checktick();
-    int			BytesPerWord;
+    uint64_t		usec[NTIMES];
+    bk_result_t		r;
+    double		best = FLT_MAX;
     int			k;
-    long		j;
-    STREAM_TYPE		scalar;
-    double		t, times[4][NTIMES];
 
-    /* --- SETUP --- determine precision and check timing --- */
+    bk_result_init(&r, "stream", bench, TOSTRING(STREAM_ARRAY_SIZE) "-" STREAM_KERNEL);
+    for (k=1; k<NTIMES; k++) {
+	usec[k-1] = (uint64_t)(times[k] * 1.0E6 + 0.5);
+	best = MIN(best, times[k]);
+	}
+    bk_stat(&r.time, usec, NTIMES-1);
+    r.pass = (err == 0);
+    r.warmup = 1;
+    r.repeat = NTIMES-1;
+    r.score = (best > 0 ? (uint64_t)(1.0E-06 * nbytes/best) : 0);
+    r.unit = "MB/s";
+    if (perf) r.perf = *perf;
+    bk_report(&r);
+    }
+
+static void
+stream_mp()
+    {
+    int			quantum = 1, checktick();
+    int			BytesPerWord;
+    int			k, err, cpu = _cpu(), ncpu = _ncpu();
+    long		j, lo, hi;
+    STREAM_TYPE		scalar;
+    double		t, best[4] = {0}, times[4][NTIMES];
+    slice_t		*s = &slice[cpu];
+    bk_time_t		tm;
+    uintptr_t		size, start, end;
+    char		buf[32];
+
+    /* --- SETUP --- carve out this CPU's slice of the arrays --- */
+
+    lo = (long)((uint64_t)STREAM_ARRAY_SIZE * cpu / ncpu);
+    hi = (long)((uint64_t)STREAM_ARRAY_SIZE * (cpu + 1) / ncpu);
+    s->n = hi - lo;
+    size = ROUNDDOWN(((uintptr_t)_heap.end - ROUNDUP(_heap.start, 64)) / ncpu, 64);
+    start = ROUNDUP(_heap.start, 64) + cpu * size;
+    end = start + size;
+    s->a = (STREAM_TYPE *)start;
+    s->b = s->a + s->n + OFFSET;
+    s->c = s->b + s->n + OFFSET;
+    if ((uintptr_t)(s->c + s->n) > end) {
+	printf("CPU %d: %d bytes of heap are not enough for %d elements per array\n",
+	    cpu, (int)size, (int)s->n);
+	_halt(1);
+	}
 
+    BytesPerWord = sizeof(STREAM_TYPE);
+    if (cpu == 0) {
     printf(HLINE);
     printf("STREAM version $Revision: 5.10 $\n");
     printf(HLINE);
-    BytesPerWord = sizeof(STREAM_TYPE);
     printf("This system uses %d bytes per array element.\n",
 	BytesPerWord);
+    printf("Kernels: %s\n", STREAM_KERNEL);
 
     printf(HLINE);
 #ifdef N
@@ -229,26 +340,35 @@ main()
 #endif
 
     printf("Array size = %llu (elements), Offset = %d (elements)\n" , (unsigned long long) STREAM_ARRAY_SIZE, OFFSET);
-    printf("Memory per array = %.1f MiB (= %.1f GiB).\n", 
+    printf("Memory per array = %.1f MiB (= %.1f GiB).\n",
 	BytesPerWord * ( (double) STREAM_ARRAY_SIZE / 1024.0/1024.0),
 	BytesPerWord * ( (double) STREAM_ARRAY_SIZE / 1024.0/1024.0/1024.0));
     printf("Total memory required = %.1f MiB (= %.1f GiB).\n",
 	(3.0 * BytesPerWord) * ( (double) STREAM_ARRAY_SIZE / 1024.0/1024.),
 	(3.0 * BytesPerWord) * ( (double) STREAM_ARRAY_SIZE / 1024.0/1024./1024.));
     printf("Each kernel will be executed %d times.\n", NTIMES);
-    printf(" The *best* time for each kernel (excluding the first iteration)\n"); 
+    printf(" The *best* time for each kernel (excluding the first iteration)\n");
     printf(" will be used to compute the reported bandwidth.\n");
+    printf("Number of CPUs = %d, about %llu elements per CPU\n",
+	ncpu, (unsigned long long) s->n);
+    }
 
-    /* Get initial value for system clock. */
-    for (j=0; j<STREAM_ARRAY_SIZE; j++) {
-	    a[j] = 1.0;
-	    b[j] = 2.0;
-	    c[j] = 0.0;
+#ifdef TUNED
+    tuned_STREAM_Init();
+#endif
+
+    /* Each CPU touches its own slice first. */
+    for (j=0; j<s->n; j++) {
+	    s->a[j] = 1.0;
+	    s->b[j] = 2.0;
+	    s->c[j] = 0.0;
 	}
+    sync_barrier();
 
+    if (cpu == 0) {
     printf(HLINE);
 
-    if  ( (quantum = checktick()) >= 1) 
+    if  ( (quantum = checktick()) >= 1)
 	printf("Your clock granularity/precision appears to be "
 	    "%d microseconds.\n", quantum);
     else {
@@ -256,12 +376,16 @@ main()
 	    "less than one microsecond.\n");
 	quantum = 1;
     }
+    }
+    sync_barrier();
 
     t = mysecond();
-    for (j = 0; j < STREAM_ARRAY_SIZE; j++)
-		a[j] = 2.0E0 * a[j];
+    for (j = 0; j < s->n; j++)
+		s->a[j] = 2.0E0 * s->a[j];
     t = 1.0E6 * (mysecond() - t);
+    sync_barrier();
 
+    if (cpu == 0) {
     printf("Each test below will take on the order"
 	" of %d microseconds.\n", (int) t  );
     printf("   (= %d clock ticks)\n", (int) (t/quantum) );
@@ -274,51 +398,42 @@ main()
     printf("For best results, please be sure you know the\n");
     printf("precision of your system timer.\n");
     printf(HLINE);
-    
+    }
+
     /*	--- MAIN LOOP --- repeat test cases NTIMES times --- */
 
     scalar = 3.0;
     for (k=0; k<NTIMES; k++)
 	{
-	times[0][k] = mysecond();
-#ifdef TUNED
-        tuned_STREAM_Copy();
-#else
-	for (j=0; j<STREAM_ARRAY_SIZE; j++)
-	    c[j] = a[j];
-#endif
-	times[0][k] = mysecond() - times[0][k];
-	
-	times[1][k] = mysecond();
-#ifdef TUNED
-        tuned_STREAM_Scale(scalar);
-#else
-	for (j=0; j<STREAM_ARRAY_SIZE; j++)
-	    b[j] = scalar*c[j];
-#endif
-	times[1][k] = mysecond() - times[1][k];
-	
-	times[2][k] = mysecond();
-#ifdef TUNED
-        tuned_STREAM_Add();
-#else
-	for (j=0; j<STREAM_ARRAY_SIZE; j++)
-	    c[j] = a[j]+b[j];
-#endif
-	times[2][k] = mysecond() - times[2][k];
-	
-	times[3][k] = mysecond();
-#ifdef TUNED
-        tuned_STREAM_Triad(scalar);
-#else
-	for (j=0; j<STREAM_ARRAY_SIZE; j++)
-	    a[j] = b[j]+scalar*c[j];
-#endif
-	times[3][k] = mysecond() - times[3][k];
+	for (j=0; j<4; j++)
+	    {
+	    sync_barrier();
+	    bk_timer_start(&tm);
+	    run_kernel(j, s, scalar);
+	    bk_timer_stop(&tm);
+	    s->times[j][k] = tm.usec * 1.0E-6;
+	    if (k == 1 || (k > 1 && s->times[j][k] < best[j])) {
+		best[j] = s->times[j][k];
+		s->perf[j] = tm.perf;
+		}
+	    }
+	}
+    sync_barrier();
+
+    if (cpu != 0) {
+	while (1) ;
 	}
 
     /*	--- SUMMARY --- */
 
+    for (k=0; k<NTIMES; k++) /* a kernel takes as long as the slowest CPU */
+	for (j=0; j<4; j++) {
+	    int c;
+	    times[j][k] = 0;
+	    for (c=0; c<ncpu; c++)
+		times[j][k] = MAX(times[j][k], slice[c].times[j][k]);
+	    }
+
     for (k=1; k<NTIMES; k++) /* note -- skip first iteration */
 	{
 	for (j=0; j<4; j++)
@@ -328,7 +443,7 @@ main()
 	    maxtime[j] = MAX(maxtime[j], times[j][k]);
 	    }
 	}
-    
+
     printf("Function    Best Rate MB/s  Avg time     Min time     Max time\n");
     for (j=0; j<4; j++) {
 		avgtime[j] = avgtime[j]/(double)(NTIMES-1);
@@ -341,10 +456,56 @@ main()
     }
     printf(HLINE);
 
+    if (ncpu > 1) {
+	int c;
+	printf("CPU   Best Rate MB/s: Copy       Scale        Add      Triad\n");
+	for (c=0; c<ncpu; c++) {
+	    printf("%3d                ", c);
+	    for (j=0; j<4; j++) {
+		double min = FLT_MAX;
+		for (k=1; k<NTIMES; k++)
+		    min = MIN(min, slice[c].times[j][k]);
+		printf(" %10.1f", 1.0E-06 * bytes[j] * slice[c].n / STREAM_ARRAY_SIZE / min);
+		}
+	    printf("\n");
+	    }
+	printf(HLINE);
+	}
+
     /* --- Check Results --- */
-    checkSTREAMresults();
+    err = checkSTREAMresults();
     printf(HLINE);
 
+    /* --- Report in the format of benchkit --- */
+    for (j=0; j<4; j++) {
+	report(name[j], times[j], bytes[j], err, ncpu == 1 ? &slice[0].perf[j] : NULL);
+	if (ncpu > 1) {
+	    int c;
+	    for (c=0; c<ncpu; c++) {
+		sprintf(buf, "%s.cpu%d", name[j], c);
+		report(buf, slice[c].times[j], bytes[j] * slice[c].n / STREAM_ARRAY_SIZE, err, &slice[c].perf[j]);
+		}
+	    }
+	}
+
+    _halt(err != 0);
+    }
+
+int
+main()
+    {
+#ifdef DUAL_CORE
+    /* the harts of xs-dual enter main() after being released */
+    _mpe_setncpu('2');
+    if (_cpu() != 0) _mpe_init(stream_mp);
+    _mpe_wakeup(1);
+#endif
+    _ioe_init();
+    assert(_ncpu() <= MAX_CPU);
+
+    _mpe_init(stream_mp);
+    /* _mpe_init() returns at once on platforms without MPE */
+    stream_mp();
     return 0;
 }
 
@@ -395,13 +556,13 @@ double mysecond()
         i = gettimeofday(&tp,&tzp);
         return ( (double) tp.tv_sec + (double) tp.tv_usec * 1.e-6 );
 		*/
-	return (double)uptime();
+	return (double)uptime_us() * 1.0E-6;
 }
 
 #ifndef abs
 #define abs(a) ((a) >= 0 ? (a) : -(a))
 #endif
-void checkSTREAMresults ()
+int checkSTREAMresults ()
 {
 	STREAM_TYPE aj,bj,cj,scalar;
 	STREAM_TYPE aSumErr,bSumErr,cSumErr;
@@ -409,6 +570,7 @@ void checkSTREAMresults ()
 	double epsilon;
 	long j;
 	int	k,ierr,err;
+	slice_t *s;
 
     /* reproduce initialization */
 	aj = 1.0;
@@ -430,10 +592,11 @@ void checkSTREAMresults ()
 	aSumErr = 0.0;
 	bSumErr = 0.0;
 	cSumErr = 0.0;
-	for (j=0; j<STREAM_ARRAY_SIZE; j++) {
-		aSumErr += abs(a[j] - aj);
-		bSumErr += abs(b[j] - bj);
-		cSumErr += abs(c[j] - cj);
+	for (s=slice; s<slice+_ncpu(); s++)
+	for (j=0; j<s->n; j++) {
+		aSumErr += abs(s->a[j] - aj);
+		bSumErr += abs(s->b[j] - bj);
+		cSumErr += abs(s->c[j] - cj);
 		// if (j == 417) printf("Index 417: c[j]: %f, cj: %f\n",c[j],cj);	// MCCALPIN
 	}
 	aAvgErr = aSumErr / (STREAM_TYPE) STREAM_ARRAY_SIZE;
@@ -457,13 +620,14 @@ void checkSTREAMresults ()
 		printf ("Failed Validation on array a[], AvgRelAbsErr > epsilon (%e)\n",epsilon);
 		printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",aj,aAvgErr,abs(aAvgErr)/aj);
 		ierr = 0;
-		for (j=0; j<STREAM_ARRAY_SIZE; j++) {
-			if (abs(a[j]/aj-1.0) > epsilon) {
+		for (s=slice; s<slice+_ncpu(); s++)
+		for (j=0; j<s->n; j++) {
+			if (abs(s->a[j]/aj-1.0) > epsilon) {
 				ierr++;
 #ifdef VERBOSE
 				if (ierr < 10) {
 					printf("         array a: index: %ld, expected: %e, observed: %e, relative error: %e\n",
-						j,aj,a[j],abs((aj-a[j])/aAvgErr));
+						j,aj,s->a[j],abs((aj-s->a[j])/aAvgErr));
 				}
 #endif
 			}
@@ -476,13 +640,14 @@ void checkSTREAMresults ()
 		printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",bj,bAvgErr,abs(bAvgErr)/bj);
 		printf ("     AvgRelAbsErr > Epsilon (%e)\n",epsilon);
 		ierr = 0;
-		for (j=0; j<STREAM_ARRAY_SIZE; j++) {
-			if (abs(b[j]/bj-1.0) > epsilon) {
+		for (s=slice; s<slice+_ncpu(); s++)
+		for (j=0; j<s->n; j++) {
+			if (abs(s->b[j]/bj-1.0) > epsilon) {
 				ierr++;
 #ifdef VERBOSE
 				if (ierr < 10) {
 					printf("         array b: index: %ld, expected: %e, observed: %e, relative error: %e\n",
-						j,bj,b[j],abs((bj-b[j])/bAvgErr));
+						j,bj,s->b[j],abs((bj-s->b[j])/bAvgErr));
 				}
 #endif
 			}
@@ -495,13 +660,14 @@ void checkSTREAMresults ()
 		printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",cj,cAvgErr,abs(cAvgErr)/cj);
 		printf ("     AvgRelAbsErr > Epsilon (%e)\n",epsilon);
 		ierr = 0;
-		for (j=0; j<STREAM_ARRAY_SIZE; j++) {
-			if (abs(c[j]/cj-1.0) > epsilon) {
+		for (s=slice; s<slice+_ncpu(); s++)
+		for (j=0; j<s->n; j++) {
+			if (abs(s->c[j]/cj-1.0) > epsilon) {
 				ierr++;
 #ifdef VERBOSE
 				if (ierr < 10) {
 					printf("         array c: index: %ld, expected: %e, observed: %e, relative error: %e\n",
-						j,cj,c[j],abs((cj-c[j])/cAvgErr));
+						j,cj,s->c[j],abs((cj-s->c[j])/cAvgErr));
 				}
 #endif
 			}
@@ -514,39 +680,8 @@ void checkSTREAMresults ()
 #ifdef VERBOSE
 	printf ("Results Validation Verbose Results: \n");
 	printf ("    Expected a(1), b(1), c(1): %f %f %f \n",aj,bj,cj);
-	printf ("    Observed a(1), b(1), c(1): %f %f %f \n",a[1],b[1],c[1]);
+	printf ("    Observed a(1), b(1), c(1): %f %f %f \n",slice[0].a[1],slice[0].b[1],slice[0].c[1]);
 	printf ("    Rel Errors on a, b, c:     %e %e %e \n",abs(aAvgErr/aj),abs(bAvgErr/bj),abs(cAvgErr/cj));
 #endif
+	return err;
 }
-
-#ifdef TUNED
-/* stubs for "tuned" versions of the kernels */
-void tuned_STREAM_Copy()
-{
-	ssize_t j;
-        for (j=0; j<STREAM_ARRAY_SIZE; j++)
-            c[j] = a[j];
-}
-
-void tuned_STREAM_Scale(STREAM_TYPE scalar)
-{
-	ssize_t j;
-	for (j=0; j<STREAM_ARRAY_SIZE; j++)
-	    b[j] = scalar*c[j];
-}
-
-void tuned_STREAM_Add()
-{
-	ssize_t j;
-	for (j=0; j<STREAM_ARRAY_SIZE; j++)
-	    c[j] = a[j]+b[j];
-}
-
-void tuned_STREAM_Triad(STREAM_TYPE scalar)
-{
-	ssize_t j;
-	for (j=0; j<STREAM_ARRAY_SIZE; j++)
-	    a[j] = b[j]+scalar*c[j];
-}
-/* end of stubs for the "tuned" versions of the kernels */
-#endif
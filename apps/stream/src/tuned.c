@@ -0,0 +1,288 @@
+/*-----------------------------------------------------------------------*/
+/* Tuned versions of the STREAM kernels for the AM port, selected with    */
+/* `make STREAM_KERNEL=<kernel>`, which defines TUNED and                 */
+/* STREAM_KERNEL_<KERNEL>. See the README for the list of kernels.        */
+/* Results obtained with them are "tuned STREAM benchmark results".      */
+/*-----------------------------------------------------------------------*/
+#include <klib.h>
+#include <klib-macros.h>
+
+#ifdef TUNED
+
+#ifndef STREAM_TYPE
+#define STREAM_TYPE double
+#endif
+
+#if defined(STREAM_KERNEL_SSE) || defined(STREAM_KERNEL_AVX) || defined(STREAM_KERNEL_RVV) || \
+    defined(STREAM_KERNEL_NT)
+/* the vector and non-temporal kernels work on 64-bit elements */
+static_assert(sizeof(STREAM_TYPE) == 8);
+#endif
+
+/*-----------------------------------------------------------------------*/
+#if defined(STREAM_KERNEL_UNROLL)
+/* 8x unrolled loops, for every ARCH */
+
+#define UNROLL8(j, n, body) \
+	for (j=0; j+8<=n; j+=8) { \
+	    body(j); body(j+1); body(j+2); body(j+3); \
+	    body(j+4); body(j+5); body(j+6); body(j+7); \
+	    } \
+	for (; j<n; j++) body(j);
+
+void tuned_STREAM_Init()
+{
+}
+
+void tuned_STREAM_Copy(STREAM_TYPE *c, const STREAM_TYPE *a, long n)
+{
+	long j;
+#define COPY(i) c[i] = a[i]
+	UNROLL8(j, n, COPY)
+}
+
+void tuned_STREAM_Scale(STREAM_TYPE *b, const STREAM_TYPE *c, STREAM_TYPE scalar, long n)
+{
+	long j;
+#define SCALE(i) b[i] = scalar*c[i]
+	UNROLL8(j, n, SCALE)
+}
+
+void tuned_STREAM_Add(STREAM_TYPE *c, const STREAM_TYPE *a, const STREAM_TYPE *b, long n)
+{
+	long j;
+#define ADD(i) c[i] = a[i]+b[i]
+	UNROLL8(j, n, ADD)
+}
+
+void tuned_STREAM_Triad(STREAM_TYPE *a, const STREAM_TYPE *b, const STREAM_TYPE *c, STREAM_TYPE scalar, long n)
+{
+	long j;
+#define TRIAD(i) a[i] = b[i]+scalar*c[i]
+	UNROLL8(j, n, TRIAD)
+}
+
+/*-----------------------------------------------------------------------*/
+#elif defined(STREAM_KERNEL_SSE) || defined(STREAM_KERNEL_AVX) || \
+      (defined(STREAM_KERNEL_NT) && defined(__ISA_NATIVE__))
+/* SSE2 or AVX on native. AM does not enable SSE on x86-qemu and
+ * x86_64-qemu, so these are for native only. The NT kernels use SSE2
+ * and write with non-temporal stores, which bypass the caches. */
+
+#if !defined(__ISA_NATIVE__) || !defined(__SSE2__)
+#error "STREAM_KERNEL=sse/avx/nt need native on an x86_64 host"
+#endif
+#if defined(STREAM_KERNEL_AVX) && !defined(__AVX__)
+#error "STREAM_KERNEL=avx needs -mavx"
+#endif
+
+#include <immintrin.h>
+
+#if defined(STREAM_KERNEL_AVX)
+#define VLEN		4
+#define vec_t		__m256d
+#define vload(p)	_mm256_loadu_pd(p)
+#define vstore(p, x)	_mm256_storeu_pd(p, x)
+#define vset1(x)	_mm256_set1_pd(x)
+#define vadd(x, y)	_mm256_add_pd(x, y)
+#define vmul(x, y)	_mm256_mul_pd(x, y)
+#else
+#define VLEN		2
+#define vec_t		__m128d
+#define vload(p)	_mm_loadu_pd(p)
+#define vset1(x)	_mm_set1_pd(x)
+#define vadd(x, y)	_mm_add_pd(x, y)
+#define vmul(x, y)	_mm_mul_pd(x, y)
+#ifdef STREAM_KERNEL_NT
+#define vstore(p, x)	_mm_stream_pd(p, x)
+#else
+#define vstore(p, x)	_mm_storeu_pd(p, x)
+#endif
+#endif
+
+/* Two vectors per iteration. The NT stores need an aligned destination,
+ * so the first element is done alone if the destination is misaligned. */
+#ifdef STREAM_KERNEL_NT
+#define HEAD(dst, j, n, body) \
+	j = 0; \
+	if (((uintptr_t)dst & 15) != 0 && n > 0) { body(0); j = 1; }
+#define TAIL() _mm_sfence();
+#else
+#define HEAD(dst, j, n, body) j = 0;
+#define TAIL()
+#endif
+
+#define KERNEL(dst, j, n, scalar_body, vec_body) \
+	HEAD(dst, j, n, scalar_body) \
+	for (; j+2*VLEN<=n; j+=2*VLEN) { \
+	    vec_body(j); vec_body(j+VLEN); \
+	    } \
+	for (; j<n; j++) scalar_body(j); \
+	TAIL()
+
+void tuned_STREAM_Init()
+{
+}
+
+void tuned_STREAM_Copy(STREAM_TYPE *c, const STREAM_TYPE *a, long n)
+{
+	long j;
+#define COPY(i)  c[i] = a[i]
+#define VCOPY(i) vstore(&c[i], vload(&a[i]))
+	KERNEL(c, j, n, COPY, VCOPY)
+}
+
+void tuned_STREAM_Scale(STREAM_TYPE *b, const STREAM_TYPE *c, STREAM_TYPE scalar, long n)
+{
+	long j;
+	vec_t s = vset1(scalar);
+#define SCALE(i)  b[i] = scalar*c[i]
+#define VSCALE(i) vstore(&b[i], vmul(s, vload(&c[i])))
+	KERNEL(b, j, n, SCALE, VSCALE)
+}
+
+void tuned_STREAM_Add(STREAM_TYPE *c, const STREAM_TYPE *a, const STREAM_TYPE *b, long n)
+{
+	long j;
+#define ADD(i)  c[i] = a[i]+b[i]
+#define VADD(i) vstore(&c[i], vadd(vload(&a[i]), vload(&b[i])))
+	KERNEL(c, j, n, ADD, VADD)
+}
+
+void tuned_STREAM_Triad(STREAM_TYPE *a, const STREAM_TYPE *b, const STREAM_TYPE *c, STREAM_TYPE scalar, long n)
+{
+	long j;
+	vec_t s = vset1(scalar);
+#define TRIAD(i)  a[i] = b[i]+scalar*c[i]
+#define VTRIAD(i) vstore(&a[i], vadd(vload(&b[i]), vmul(s, vload(&c[i]))))
+	KERNEL(a, j, n, TRIAD, VTRIAD)
+}
+
+/*-----------------------------------------------------------------------*/
+#elif defined(STREAM_KERNEL_RVV)
+/* RISC-V Vector extension 1.0, with LMUL=8 register groups. The loops
+ * are strip-mined by vsetvli, so there is no scalar tail. */
+
+#if !defined(__riscv) || __riscv_xlen != 64 || !defined(__riscv_vector)
+#error "STREAM_KERNEL=rvv needs riscv64 with the V extension"
+#endif
+
+#define MSTATUS_VS_INITIAL (1 << 9)
+
+/* the register groups written by the asm below, so that GCC keeps no
+ * auto-vectorized values in them */
+#define CLOBBER_V0_M8 "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v7"
+#define CLOBBER_V8_M8 "v8", "v9", "v10", "v11", "v12", "v13", "v14", "v15"
+
+void tuned_STREAM_Init()
+{
+	/* AM runs in M-mode; vector instructions trap while mstatus.VS is Off */
+	asm volatile("csrs mstatus, %0" : : "r"(MSTATUS_VS_INITIAL));
+}
+
+void tuned_STREAM_Copy(STREAM_TYPE *c, const STREAM_TYPE *a, long n)
+{
+	long vl;
+	for (; n > 0; n -= vl, a += vl, c += vl)
+	    asm volatile("vsetvli %0, %1, e64, m8, ta, ma;"
+			 "vle64.v v0, (%2);"
+			 "vse64.v v0, (%3);"
+			 : "=&r"(vl) : "r"(n), "r"(a), "r"(c) : "memory", CLOBBER_V0_M8);
+}
+
+void tuned_STREAM_Scale(STREAM_TYPE *b, const STREAM_TYPE *c, STREAM_TYPE scalar, long n)
+{
+	long vl;
+	for (; n > 0; n -= vl, b += vl, c += vl)
+	    asm volatile("vsetvli %0, %1, e64, m8, ta, ma;"
+			 "vle64.v v0, (%2);"
+			 "vfmul.vf v0, v0, %4;"
+			 "vse64.v v0, (%3);"
+			 : "=&r"(vl) : "r"(n), "r"(c), "r"(b), "f"(scalar) : "memory", CLOBBER_V0_M8);
+}
+
+void tuned_STREAM_Add(STREAM_TYPE *c, const STREAM_TYPE *a, const STREAM_TYPE *b, long n)
+{
+	long vl;
+	for (; n > 0; n -= vl, a += vl, b += vl, c += vl)
+	    asm volatile("vsetvli %0, %1, e64, m8, ta, ma;"
+			 "vle64.v v0, (%2);"
+			 "vle64.v v8, (%3);"
+			 "vfadd.vv v0, v0, v8;"
+			 "vse64.v v0, (%4);"
+			 : "=&r"(vl) : "r"(n), "r"(a), "r"(b), "r"(c) : "memory",
+			   CLOBBER_V0_M8, CLOBBER_V8_M8);
+}
+
+void tuned_STREAM_Triad(STREAM_TYPE *a, const STREAM_TYPE *b, const STREAM_TYPE *c, STREAM_TYPE scalar, long n)
+{
+	long vl;
+	for (; n > 0; n -= vl, a += vl, b += vl, c += vl)
+	    asm volatile("vsetvli %0, %1, e64, m8, ta, ma;"
+			 "vle64.v v0, (%2);"
+			 "vle64.v v8, (%3);"
+			 "vfmacc.vf v0, %5, v8;"
+			 "vse64.v v0, (%4);"
+			 : "=&r"(vl) : "r"(n), "r"(b), "r"(c), "r"(a), "f"(scalar) : "memory",
+			   CLOBBER_V0_M8, CLOBBER_V8_M8);
+}
+
+/*-----------------------------------------------------------------------*/
+#elif defined(STREAM_KERNEL_NT)
+/* 4x unrolled loops with non-temporal stores on riscv64: every store is
+ * preceded by the ntl.all hint of Zihintntl, encoded as "add x0, x0, x5",
+ * which is a no-op on cores without the extension. */
+
+#if !defined(__riscv) || __riscv_xlen != 64
+#error "STREAM_KERNEL=nt needs native or riscv64"
+#endif
+
+static inline void store_nt(STREAM_TYPE *p, STREAM_TYPE x)
+{
+	asm volatile("add x0, x0, x5; fsd %1, 0(%0);" : : "r"(p), "f"(x) : "memory");
+}
+
+#define UNROLL4(j, n, body) \
+	for (j=0; j+4<=n; j+=4) { \
+	    body(j); body(j+1); body(j+2); body(j+3); \
+	    } \
+	for (; j<n; j++) body(j);
+
+void tuned_STREAM_Init()
+{
+}
+
+void tuned_STREAM_Copy(STREAM_TYPE *c, const STREAM_TYPE *a, long n)
+{
+	long j;
+#define COPY(i) store_nt(&c[i], a[i])
+	UNROLL4(j, n, COPY)
+}
+
+void tuned_STREAM_Scale(STREAM_TYPE *b, const STREAM_TYPE *c, STREAM_TYPE scalar, long n)
+{
+	long j;
+#define SCALE(i) store_nt(&b[i], scalar*c[i])
+	UNROLL4(j, n, SCALE)
+}
+
+void tuned_STREAM_Add(STREAM_TYPE *c, const STREAM_TYPE *a, const STREAM_TYPE *b, long n)
+{
+	long j;
+#define ADD(i) store_nt(&c[i], a[i]+b[i])
+	UNROLL4(j, n, ADD)
+}
+
+void tuned_STREAM_Triad(STREAM_TYPE *a, const STREAM_TYPE *b, const STREAM_TYPE *c, STREAM_TYPE scalar, long n)
+{
+	long j;
+#define TRIAD(i) store_nt(&a[i], b[i]+scalar*c[i])
+	UNROLL4(j, n, TRIAD)
+}
+
+/*-----------------------------------------------------------------------*/
+#else
+#error "unknown STREAM_KERNEL"
+#endif
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef __BENCHKIT_H__
+#define __BENCHKIT_H__
+
+#include <am.h>
+#include <amdev.h>
+#include <klib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Timing, repetition and reporting shared by the benchmark apps, so that
+// every benchmark on every ARCH reports its results in the same format.
+
+// ============================ Cases ============================
+
+// A benchmark case. Only run() is timed; validate() returns 1 if the
+// result is correct. prepare() and validate() may be NULL.
+typedef struct bk_case {
+  const char *name, *desc;
+  void (*prepare)();
+  void (*run)();
+  int (*validate)();
+} bk_case_t;
+
+// An app lists its cases in an X-macro, e.g.
+//   #define LIST(def) def(foo, "foo", "Foo") def(bar, "bar", "Bar")
+//   LIST(BENCHKIT_DECL)
+//   bk_case_t cases[] = { LIST(BENCHKIT_CASE) };
+// and implements bench_foo_prepare(), bench_foo_run() and bench_foo_validate().
+#define BENCHKIT_DECL(_name, _sname, _desc, ...) \
+  void bench_##_name##_prepare(); \
+  void bench_##_name##_run(); \
+  int bench_##_name##_validate();
+
+#define BENCHKIT_CASE(_name, _sname, _desc, ...) \
+  { .name = _sname, .desc = _desc, \
+    .prepare = bench_##_name##_prepare, \
+    .run = bench_##_name##_run, \
+    .validate = bench_##_name##_validate, },
+
+// ============================ Timer ============================
+
+// Elapsed wall-clock time and hardware counters of a timed region. The
+// counters are those of _DEV_PERFCNT, and perf.valid tells which of them
+// the platform supports.
+typedef struct bk_time {
+  uint64_t usec;
+  _DEV_PERFCNT_READ_t perf;
+} bk_time_t;
+
+void bk_timer_start(bk_time_t *t);
+void bk_timer_stop(bk_time_t *t); // t now holds the differences
+
+// ========================= Statistics ==========================
+
+typedef struct bk_stat {
+  uint64_t min, median, mean, stddev;
+} bk_stat_t;
+
+// Statistics of n >= 1 samples, which are sorted in place
+void bk_stat(bk_stat_t *st, uint64_t *samples, int n);
+
+// ==================== Warmup/repeat policy =====================
+
+#define BK_MAX_REPEAT 64
+
+typedef struct bk_policy {
+  int warmup, repeat;
+  void (*reset)(); // called before every prepare() if not NULL
+} bk_policy_t;
+
+// Parse a "warmup=N" or "repeat=N" option into the policy. Return 0 if
+// the option is not one of them or its value is out of range.
+int bk_parse_option(bk_policy_t *p, const char *opt);
+
+// ============================ Results ==========================
+
+typedef struct bk_result {
+  const char *suite, *bench, *input;
+  int pass;
+  int warmup, repeat;
+  bk_stat_t time;           // of the timed runs, in us
+  _DEV_PERFCNT_READ_t perf; // of the fastest run
+  uint64_t score;
+  const char *unit;         // of the score, NULL if there is no score
+  int has_checksum;
+  uint32_t checksum, expected;
+} bk_result_t;
+
+// Fill in suite/bench/input and clear everything else
+void bk_result_init(bk_result_t *r, const char *suite, const char *bench, const char *input);
+
+// Result of a single timed region
+void bk_result_time(bk_result_t *r, const bk_time_t *t);
+
+// Run a case p->warmup times untimed and then p->repeat times timed,
+// printing "." or "*" for each passed run and "x" or "X" for each failed
+// one. Fill in pass, warmup, repeat, time and perf of the result.
+void bk_run(const bk_case_t *c, const bk_policy_t *p, bk_result_t *r);
+
+// Print the result as a single line of JSON, e.g.
+// {"suite": "microbench", "bench": "qsort", "input": "ref", "arch": "riscv64-noop",
+//  "pass": 1, "warmup": 0, "repeat": 1, "min_us": 51140, "median_us": 51140,
+//  "mean_us": 51140, "stddev_us": 0, "score": 10000, "unit": "Marks",
+//  "checksum": "0xed8cff89", "expected": "0xed8cff89", "cycle": 102280000}
+// Keys for the checksum, the score and the counters are only present if
+// the result has them.
+void bk_report(const bk_result_t *r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
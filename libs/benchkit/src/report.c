@@ -0,0 +1,40 @@
+#include <benchkit.h>
+#include <klib-macros.h>
+
+void bk_result_init(bk_result_t *r, const char *suite, const char *bench, const char *input) {
+  memset(r, 0, sizeof(*r));
+  r->suite = suite;
+  r->bench = bench;
+  r->input = input;
+  r->repeat = 1;
+}
+
+void bk_result_time(bk_result_t *r, const bk_time_t *t) {
+  r->warmup = 0;
+  r->repeat = 1;
+  r->time.min = r->time.median = r->time.mean = t->usec;
+  r->time.stddev = 0;
+  r->perf = t->perf;
+}
+
+void bk_report(const bk_result_t *r) {
+  printf("{\"suite\": \"%s\", \"bench\": \"%s\", \"input\": \"%s\", \"arch\": \"%s\", "
+         "\"pass\": %d, \"warmup\": %d, \"repeat\": %d, ",
+         r->suite, r->bench, r->input ? r->input : "", TOSTRING(__ARCH__),
+         r->pass, r->warmup, r->repeat);
+  printf("\"min_us\": %llu, \"median_us\": %llu, \"mean_us\": %llu, \"stddev_us\": %llu",
+         (unsigned long long)r->time.min, (unsigned long long)r->time.median,
+         (unsigned long long)r->time.mean, (unsigned long long)r->time.stddev);
+  if (r->unit) {
+    printf(", \"score\": %llu, \"unit\": \"%s\"", (unsigned long long)r->score, r->unit);
+  }
+  if (r->has_checksum) {
+    printf(", \"checksum\": \"0x%08x\", \"expected\": \"0x%08x\"", r->checksum, r->expected);
+  }
+  const _DEV_PERFCNT_READ_t *p = &r->perf;
+  if (p->valid & _PERFCNT_CYCLE)     printf(", \"cycle\": %llu", (unsigned long long)p->cycle);
+  if (p->valid & _PERFCNT_INSTRET)   printf(", \"instret\": %llu", (unsigned long long)p->instret);
+  if (p->valid & _PERFCNT_CACHEMISS) printf(", \"cachemiss\": %llu", (unsigned long long)p->cachemiss);
+  if (p->valid & _PERFCNT_BRMISS)    printf(", \"brmiss\": %llu", (unsigned long long)p->brmiss);
+  printf("}\n");
+}
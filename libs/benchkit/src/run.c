@@ -0,0 +1,53 @@
+#include <benchkit.h>
+
+int bk_parse_option(bk_policy_t *p, const char *opt) {
+  int *val;
+  if      (strncmp(opt, "warmup=", 7) == 0) val = &p->warmup;
+  else if (strncmp(opt, "repeat=", 7) == 0) val = &p->repeat;
+  else return 0;
+
+  char *end;
+  long n = strtol(opt + 7, &end, 10);
+  if (end == opt + 7 || *end != '\0') return 0;
+  if (n < (val == &p->repeat ? 1 : 0) || n > BK_MAX_REPEAT) return 0;
+  *val = n;
+  return 1;
+}
+
+static int run_once(const bk_case_t *c, const bk_policy_t *p, bk_time_t *t) {
+  if (p->reset) p->reset();
+  if (c->prepare) c->prepare();
+  bk_timer_start(t);
+  c->run();
+  bk_timer_stop(t);
+  return c->validate ? c->validate() : 1;
+}
+
+void bk_run(const bk_case_t *c, const bk_policy_t *p, bk_result_t *r) {
+  assert(p->repeat >= 1 && p->repeat <= BK_MAX_REPEAT);
+  bk_time_t t;
+  uint64_t samples[BK_MAX_REPEAT];
+  int pass = 1;
+  uint64_t best = 0;
+
+  for (int i = 0; i < p->warmup; i ++) {
+    int ok = run_once(c, p, &t);
+    printf(ok ? "." : "x");
+    pass &= ok;
+  }
+  for (int i = 0; i < p->repeat; i ++) {
+    int ok = run_once(c, p, &t);
+    printf(ok ? "*" : "X");
+    pass &= ok;
+    samples[i] = t.usec;
+    if (i == 0 || t.usec < best) {
+      best = t.usec;
+      r->perf = t.perf;
+    }
+  }
+
+  r->pass = pass;
+  r->warmup = p->warmup;
+  r->repeat = p->repeat;
+  bk_stat(&r->time, samples, p->repeat);
+}
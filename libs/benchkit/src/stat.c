@@ -0,0 +1,38 @@
+#include <benchkit.h>
+
+// Integer arithmetic only, since some platforms have no FPU
+
+static uint64_t isqrt(uint64_t x) {
+  uint64_t r = 0, bit = (uint64_t)1 << 62;
+  while (bit > x) bit >>= 2;
+  for (; bit != 0; bit >>= 2) {
+    if (x >= r + bit) {
+      x -= r + bit;
+      r = (r >> 1) + bit;
+    } else {
+      r >>= 1;
+    }
+  }
+  return r;
+}
+
+void bk_stat(bk_stat_t *st, uint64_t *t, int n) {
+  assert(n >= 1);
+  // insertion sort, n is small
+  for (int i = 1; i < n; i ++) {
+    uint64_t x = t[i];
+    int j = i;
+    for (; j > 0 && t[j - 1] > x; j --) t[j] = t[j - 1];
+    t[j] = x;
+  }
+  uint64_t sum = 0, var = 0;
+  for (int i = 0; i < n; i ++) sum += t[i];
+  st->min = t[0];
+  st->median = (n % 2 == 1 ? t[n / 2] : (t[n / 2 - 1] + t[n / 2]) / 2);
+  st->mean = (sum + n / 2) / n;
+  for (int i = 0; i < n; i ++) {
+    int64_t d = (int64_t)t[i] - (int64_t)st->mean;
+    var += d * d;
+  }
+  st->stddev = (n > 1 ? isqrt(var / (n - 1)) : 0);
+}
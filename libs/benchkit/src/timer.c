@@ -0,0 +1,22 @@
+#include <benchkit.h>
+
+static void read_perfcnt(_DEV_PERFCNT_READ_t *cnt) {
+  cnt->valid = 0; // not every platform has the device
+  _io_read(_DEV_PERFCNT, _DEVREG_PERFCNT_READ, cnt, sizeof(*cnt));
+}
+
+void bk_timer_start(bk_time_t *t) {
+  read_perfcnt(&t->perf);
+  t->usec = uptime_us();
+}
+
+void bk_timer_stop(bk_time_t *t) {
+  t->usec = uptime_us() - t->usec;
+  _DEV_PERFCNT_READ_t end;
+  read_perfcnt(&end);
+  t->perf.valid &= end.valid;
+  t->perf.cycle = end.cycle - t->perf.cycle;
+  t->perf.instret = end.instret - t->perf.instret;
+  t->perf.cachemiss = end.cachemiss - t->perf.cachemiss;
+  t->perf.brmiss = end.brmiss - t->perf.brmiss;
+}
@@ -27,6 +27,14 @@
 #define snprintf my_snprintf
 #define malloc my_malloc
 #define free my_free
+#define strchr my_strchr
+#define strrchr my_strrchr
+#define strstr my_strstr
+#define strtok my_strtok
+#define strtol my_strtol
+#define strtoul my_strtoul
+#define qsort my_qsort
+#define bsearch my_bsearch
 #endif
 
 #ifdef __cplusplus
@@ -36,10 +44,14 @@ extern "C" {
 // am devices
 
 uint32_t uptime();
+uint64_t uptime_us();
+uint64_t read_cycle();
 void get_timeofday(void *rtc);
 int read_key();
 void draw_rect(uint32_t *pixels, int x, int y, int w, int h);
 void draw_sync();
+uint32_t *fb_addr();
+void fb_present(int x, int y, int w, int h);
 int screen_width();
 int screen_height();
 
@@ -67,6 +79,37 @@ void srand(unsigned int seed);
 int rand();
 void *malloc(size_t size);
 void free(void *ptr);
+int atexit(void (*func)(void));
+long strtol(const char *nptr, char **endptr, int base);
+unsigned long strtoul(const char *nptr, char **endptr, int base);
+void qsort(void *base, size_t nmemb, size_t size, int (*compar)(const void *, const void *));
+void *bsearch(const void *key, const void *base, size_t nmemb, size_t size,
+    int (*compar)(const void *, const void *));
+
+// sync.c: atomics, spinlocks and barrier for multiple CPUs
+intptr_t sync_cas(volatile intptr_t *addr, intptr_t expect, intptr_t newval); // returns the old value
+intptr_t sync_xchg(volatile intptr_t *addr, intptr_t newval);
+intptr_t sync_fetch_add(volatile intptr_t *addr, intptr_t val);
+
+typedef struct {
+  volatile intptr_t next, serving;
+} ticket_lock_t;
+#define TICKET_LOCK_INIT { 0, 0 }
+void ticket_lock(ticket_lock_t *lk);
+void ticket_unlock(ticket_lock_t *lk);
+
+typedef struct mcs_node {
+  struct mcs_node *volatile next;
+  volatile intptr_t wait;
+} mcs_node_t;
+typedef struct {
+  mcs_node_t *volatile tail;
+} mcs_lock_t;
+#define MCS_LOCK_INIT { NULL }
+void mcs_lock(mcs_lock_t *lk, mcs_node_t *node);
+void mcs_unlock(mcs_lock_t *lk, mcs_node_t *node);
+
+void sync_barrier(); // wait for all _ncpu() CPUs
 
 // in "printf.h"
 // int printf(const char* fmt, ...);
@@ -76,8 +119,6 @@ void free(void *ptr);
 // int vsnprintf(char *str, size_t size, const char *format, va_list ap);
 // int sscanf(const char *str, const char *format, ...);
 
-void qsort(void *base, size_t nmemb, size_t size, int (*compar)(const void *, const void *));
-
 // assert.h
 #ifdef NDEBUG
   #define assert(ignore) ((void)0)
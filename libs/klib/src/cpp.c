@@ -2,18 +2,107 @@
 
 #ifndef __ISA_NATIVE__
 
+// Minimal C++ ABI support for freestanding programs. operator new and
+// delete are in new.cpp.
+
 void __dso_handle() {
 }
 
-void __cxa_guard_acquire() {
+static inline void lock(intptr_t *lk) {
+  while (_atomic_xchg(lk, 1) != 0) ;
+  __sync_synchronize();
+}
+
+static inline void unlock(intptr_t *lk) {
+  __sync_synchronize();
+  _atomic_xchg(lk, 0);
+}
+
+// Guards of function-local statics. The compiler tests the first byte of
+// the guard inline, and only calls __cxa_guard_acquire() when it is zero.
+// The first word of the guard is GUARD_DONE after the initialization, and
+// GUARD_BUSY while some CPU is running it (the first byte is still zero).
+// Values are stored with plain stores, and _atomic_xchg() only decides who
+// runs the initializer, since the dummy one for single-core platforms does
+// not store anything.
+
+#define GUARD_DONE 0x001
+#define GUARD_BUSY 0x100
+
+int __cxa_guard_acquire(volatile intptr_t *g) {
+  while (1) {
+    if (*g == GUARD_DONE) return 0;
+    intptr_t old = _atomic_xchg(g, GUARD_BUSY);
+    if (old == 0) return 1;
+    if (old == GUARD_DONE) {
+      // another CPU finished it in the meantime, undo our store
+      *g = GUARD_DONE;
+      return 0;
+    }
+    // GUARD_BUSY: wait for the CPU running the initializer
+  }
+}
+
+void __cxa_guard_release(volatile intptr_t *g) {
+  __sync_synchronize();
+  *g = GUARD_DONE;
+}
+
+void __cxa_guard_abort(volatile intptr_t *g) {
+  __sync_synchronize();
+  *g = 0;
+}
+
+// Destructors of static objects and atexit() functions, run in reverse
+// order of registration by __cxa_finalize(), which _halt() calls.
+
+#define NR_ATEXIT 64
+
+static struct {
+  void (*func)(void *);
+  void *arg;
+  void *dso;
+} atexit_fn[NR_ATEXIT];
+static int nr_atexit = 0;
+static intptr_t atexit_lock = 0;
+
+int __cxa_atexit(void (*func)(void *), void *arg, void *dso) {
+  int ret = -1;
+  lock(&atexit_lock);
+  if (nr_atexit < NR_ATEXIT) {
+    atexit_fn[nr_atexit].func = func;
+    atexit_fn[nr_atexit].arg = arg;
+    atexit_fn[nr_atexit].dso = dso;
+    nr_atexit ++;
+    ret = 0;
+  }
+  unlock(&atexit_lock);
+  return ret;
 }
 
-void __cxa_guard_release() {
+int atexit(void (*func)(void)) {
+  return __cxa_atexit((void (*)(void *))func, NULL, NULL);
 }
 
+void __cxa_finalize(void *dso) {
+  while (1) {
+    // remove the entry before calling it, so that a function which
+    // registers more functions or calls _halt() again does not rerun it
+    lock(&atexit_lock);
+    int i = nr_atexit - 1;
+    while (i >= 0 && dso != NULL && atexit_fn[i].dso != dso) i --;
+    if (i < 0) {
+      unlock(&atexit_lock);
+      return;
+    }
+    void (*func)(void *) = atexit_fn[i].func;
+    void *arg = atexit_fn[i].arg;
+    for (; i < nr_atexit - 1; i ++) atexit_fn[i] = atexit_fn[i + 1];
+    nr_atexit --;
+    unlock(&atexit_lock);
 
-void __cxa_atexit() {
-  assert(0);
+    func(arg);
+  }
 }
 
 #endif
@@ -62,22 +62,68 @@ __udivdi3(du_int a, du_int b)
 }
 
 
+/* Returns: u1:u0 / v, *rem = u1:u0 % v, given u1 < v.
+ * The general case is Hacker's Delight `divlu`: normalize v by its leading
+ * zeros and produce the quotient in two 16-bit digits, so that only 32-bit
+ * hardware divisions are needed. */
+
+static su_int
+udiv64by32(su_int u1, su_int u0, su_int v, su_int* rem)
+{
+#if defined(__i386__)
+    su_int q, r;
+    asm ("divl %4" : "=a"(q), "=d"(r) : "a"(u0), "d"(u1), "rm"(v));
+    *rem = r;
+    return q;
+#else
+    const su_int b = 1u << 16;
+    const int s = __builtin_clz(v);
+    v <<= s;
+    const su_int vn1 = v >> 16, vn0 = v & 0xffff;
+    const su_int un32 = (u1 << s) | (s == 0 ? 0 : u0 >> (32 - s));
+    const su_int un10 = u0 << s;
+    const su_int un1 = un10 >> 16, un0 = un10 & 0xffff;
+
+    /* the estimated digit is at most 2 too large */
+    su_int q1 = un32 / vn1, rhat = un32 - q1 * vn1;
+    while (q1 >= b || q1 * vn0 > b * rhat + un1)
+    {
+        q1--;
+        rhat += vn1;
+        if (rhat >= b) break;
+    }
+
+    const su_int un21 = un32 * b + un1 - q1 * v;
+    su_int q0 = un21 / vn1;
+    rhat = un21 - q0 * vn1;
+    while (q0 >= b || q0 * vn0 > b * rhat + un0)
+    {
+        q0--;
+        rhat += vn1;
+        if (rhat >= b) break;
+    }
+
+    *rem = (un21 * b + un0 - q0 * v) >> s;
+    return q1 * b + q0;
+#endif
+}
+
+/* Returns: a / b, *rem = a % b
+ * Instead of shifting out one quotient bit per iteration, the quotient is
+ * computed with at most two 64/32 divisions (Hacker's Delight `divDU`). */
+
 COMPILER_RT_ABI du_int
 __udivmoddi4(du_int a, du_int b, du_int* rem)
 {
-    const unsigned n_uword_bits = sizeof(su_int) * CHAR_BIT;
-    const unsigned n_udword_bits = sizeof(du_int) * CHAR_BIT;
     udwords n;
     n.all = a;
     udwords d;
     d.all = b;
     udwords q;
     udwords r;
-    unsigned sr;
-    /* special cases, X is unknown, K != 0 */
-    if (n.s.high == 0)
+    if (d.s.high == 0)
     {
-        if (d.s.high == 0)
+        if (n.s.high == 0)
         {
             /* 0 X
              * ---
@@ -87,186 +133,56 @@ __udivmoddi4(du_int a, du_int b, du_int* rem)
                 *rem = n.s.low % d.s.low;
             return n.s.low / d.s.low;
         }
-        /* 0 X
+        /* K X
          * ---
-         * K X
+         * 0 K
          */
-        if (rem)
-            *rem = n.s.low;
-        return 0;
-    }
-    /* n.s.high != 0 */
-    if (d.s.low == 0)
-    {
-        if (d.s.high == 0)
+        if (n.s.high < d.s.low)
         {
-            /* K X
-             * ---
-             * 0 0
-             */
-            if (rem)
-                *rem = n.s.high % d.s.low;
-            return n.s.high / d.s.low;
+            q.s.high = 0;
+            q.s.low = udiv64by32(n.s.high, n.s.low, d.s.low, &r.s.low);
         }
-        /* d.s.high != 0 */
-        if (n.s.low == 0)
+        else
         {
-            /* K 0
-             * ---
-             * K 0
-             */
-            if (rem)
-            {
-                r.s.high = n.s.high % d.s.high;
-                r.s.low = 0;
-                *rem = r.all;
-            }
-            return n.s.high / d.s.high;
+            /* divide the high word first, so that the remainder
+             * is below the divisor for the second step */
+            q.s.high = n.s.high / d.s.low;
+            su_int t = n.s.high - q.s.high * d.s.low;
+            q.s.low = udiv64by32(t, n.s.low, d.s.low, &r.s.low);
         }
-        /* K K
+        r.s.high = 0;
+    }
+    else
+    {
+        /* X X
          * ---
-         * K 0
+         * K X
          */
-        if ((d.s.high & (d.s.high - 1)) == 0)     /* if d is a power of 2 */
+        if (n.all < d.all)
         {
             if (rem)
-            {
-                r.s.low = n.s.low;
-                r.s.high = n.s.high & (d.s.high - 1);
-                *rem = r.all;
-            }
-            return n.s.high >> __builtin_ctz(d.s.high);
-        }
-        /* K K
-         * ---
-         * K 0
-         */
-        sr = __builtin_clz(d.s.high) - __builtin_clz(n.s.high);
-        /* 0 <= sr <= n_uword_bits - 2 or sr large */
-        if (sr > n_uword_bits - 2)
-        {
-           if (rem)
                 *rem = n.all;
             return 0;
         }
-        ++sr;
-        /* 1 <= sr <= n_uword_bits - 1 */
-        /* q.all = n.all << (n_udword_bits - sr); */
-        q.s.low = 0;
-        q.s.high = n.s.low << (n_uword_bits - sr);
-        /* r.all = n.all >> sr; */
-        r.s.high = n.s.high >> sr;
-        r.s.low = (n.s.high << (n_uword_bits - sr)) | (n.s.low >> sr);
-    }
-    else  /* d.s.low != 0 */
-    {
-        if (d.s.high == 0)
-        {
-            /* K X
-             * ---
-             * 0 K
-             */
-            if ((d.s.low & (d.s.low - 1)) == 0)     /* if d is a power of 2 */
-            {
-                if (rem)
-                    *rem = n.s.low & (d.s.low - 1);
-                if (d.s.low == 1)
-                    return n.all;
-                sr = __builtin_ctz(d.s.low);
-                q.s.high = n.s.high >> sr;
-                q.s.low = (n.s.high << (n_uword_bits - sr)) | (n.s.low >> sr);
-                return q.all;
-            }
-            /* K X
-             * ---
-             * 0 K
-             */
-            sr = 1 + n_uword_bits + __builtin_clz(d.s.low) - __builtin_clz(n.s.high);
-            /* 2 <= sr <= n_udword_bits - 1
-             * q.all = n.all << (n_udword_bits - sr);
-             * r.all = n.all >> sr;
-             */
-            if (sr == n_uword_bits)
-            {
-                q.s.low = 0;
-                q.s.high = n.s.low;
-                r.s.high = 0;
-                r.s.low = n.s.high;
-            }
-            else if (sr < n_uword_bits)  // 2 <= sr <= n_uword_bits - 1
-            {
-                q.s.low = 0;
-                q.s.high = n.s.low << (n_uword_bits - sr);
-                r.s.high = n.s.high >> sr;
-                r.s.low = (n.s.high << (n_uword_bits - sr)) | (n.s.low >> sr);
-            }
-            else              // n_uword_bits + 1 <= sr <= n_udword_bits - 1
-            {
-                q.s.low = n.s.low << (n_udword_bits - sr);
-                q.s.high = (n.s.high << (n_udword_bits - sr)) |
-                           (n.s.low >> (sr - n_uword_bits));
-                r.s.high = 0;
-                r.s.low = n.s.high >> (sr - n_uword_bits);
-            }
-        }
-        else
+        /* the quotient fits in 32 bits: estimate it from the top 32 bits
+         * of the normalized divisor, then correct it by at most one */
+        const int s = __builtin_clz(d.s.high);
+        const su_int v1 = (s == 0 ? d.s.high :
+                           (d.s.high << s) | (d.s.low >> (32 - s)));
+        udwords n1;
+        n1.all = n.all >> 1;
+        su_int t;
+        su_int q0 = udiv64by32(n1.s.high, n1.s.low, v1, &t) >> (31 - s);
+        if (q0 != 0)
+            q0--;
+        r.all = n.all - ((du_int)q0 * d.s.low + ((du_int)(q0 * d.s.high) << 32));
+        if (r.all >= d.all)
         {
-            /* K X
-             * ---
-             * K K
-             */
-            sr = __builtin_clz(d.s.high) - __builtin_clz(n.s.high);
-            /* 0 <= sr <= n_uword_bits - 1 or sr large */
-            if (sr > n_uword_bits - 1)
-            {
-                if (rem)
-                    *rem = n.all;
-                return 0;
-            }
-            ++sr;
-            /* 1 <= sr <= n_uword_bits */
-            /*  q.all = n.all << (n_udword_bits - sr); */
-            q.s.low = 0;
-            if (sr == n_uword_bits)
-            {
-                q.s.high = n.s.low;
-                r.s.high = 0;
-                r.s.low = n.s.high;
-            }
-            else
-            {
-                q.s.high = n.s.low << (n_uword_bits - sr);
-                r.s.high = n.s.high >> sr;
-                r.s.low = (n.s.high << (n_uword_bits - sr)) | (n.s.low >> sr);
-            }
+            q0++;
+            r.all -= d.all;
         }
+        q.all = q0;
     }
-    /* Not a special case
-     * q and r are initialized with:
-     * q.all = n.all << (n_udword_bits - sr);
-     * r.all = n.all >> sr;
-     * 1 <= sr <= n_udword_bits - 1
-     */
-    su_int carry = 0;
-    for (; sr > 0; --sr)
-    {
-        /* r:q = ((r:q)  << 1) | carry */
-        r.s.high = (r.s.high << 1) | (r.s.low  >> (n_uword_bits - 1));
-        r.s.low  = (r.s.low  << 1) | (q.s.high >> (n_uword_bits - 1));
-        q.s.high = (q.s.high << 1) | (q.s.low  >> (n_uword_bits - 1));
-        q.s.low  = (q.s.low  << 1) | carry;
-        /* carry = 0;
-         * if (r.all >= d.all)
-         * {
-         *      r.all -= d.all;
-         *      carry = 1;
-         * }
-         */
-        const di_int s = (di_int)(d.all - r.all - 1) >> (n_udword_bits - 1);
-        carry = s & 1;
-        r.all -= d.all & s;
-    }
-    q.all = (q.all << 1) | carry;
     if (rem)
         *rem = r.all;
     return q.all;
@@ -283,19 +199,48 @@ __umoddi3(du_int a, du_int b)
 }
 
 
+/* 32x32 -> 64 multiplication built from 16-bit halves, for cores whose
+ * multiplier only returns the low 32 bits of the product. */
+
+static du_int umul32x32(su_int a, su_int b) {
+  su_int al = a & 0xffff, ah = a >> 16;
+  su_int bl = b & 0xffff, bh = b >> 16;
+  su_int ll = al * bl, lh = al * bh, hl = ah * bl, hh = ah * bh;
+  su_int mid = (ll >> 16) + (lh & 0xffff) + (hl & 0xffff);
+  udwords r;
+  r.s.low = (mid << 16) | (ll & 0xffff);
+  r.s.high = hh + (lh >> 16) + (hl >> 16) + (mid >> 16);
+  return r.all;
+}
+
+/* Returns: a * b
+ * Only the low 64 bits are kept, so the high x high product is never
+ * needed, and the cross products only contribute their low words. */
+
+COMPILER_RT_ABI di_int __muldi3(di_int a, di_int b) {
+  udwords x, y, r;
+  x.all = a;
+  y.all = b;
+  r.all = umul32x32(x.s.low, y.s.low);
+  r.s.high += x.s.high * y.s.low + x.s.low * y.s.high;
+  return r.all;
+}
+
 // for more details, refer to
 // https://gcc.gnu.org/onlinedocs/gccint/Integer-library-routines.html
 
 int __clzsi2 (unsigned int a) {
-  if (a == 0) return 0;
-  int bit = 31;
-  while ((a & (1 << bit)) == 0) bit --;
-  return bit;
+  // binary search down to a nibble, then look it up
+  static const char clz4[16] = { 4, 3, 2, 2, 1, 1, 1, 1 };
+  int n = 0;
+  if ((a >> 16) == 0) { n += 16; a <<= 16; }
+  if ((a >> 24) == 0) { n += 8;  a <<= 8; }
+  if ((a >> 28) == 0) { n += 4;  a <<= 4; }
+  return n + clz4[a >> 28];
 }
 
 int __ctzsi2 (unsigned int a) {
-  if (a == 0) return 0;
-  int bit = 0;
-  while ((a & (1 << bit)) == 0) bit ++;
-  return bit;
+  if (a == 0) return 32;
+  // isolate the lowest set bit
+  return 31 - __clzsi2(a & -a);
 }
@@ -7,6 +7,18 @@ uint32_t uptime() {
   return uptime.lo;
 }
 
+uint64_t uptime_us() {
+  _DEV_TIMER_USEC_t usec;
+  _io_read(_DEV_TIMER, _DEVREG_TIMER_USEC, &usec, sizeof(usec));
+  return usec.us;
+}
+
+uint64_t read_cycle() {
+  _DEV_TIMER_CYCLE_t cycle;
+  _io_read(_DEV_TIMER, _DEVREG_TIMER_CYCLE, &cycle, sizeof(cycle));
+  return cycle.cycle;
+}
+
 void get_timeofday(void *rtc) {
   _io_read(_DEV_TIMER, _DEVREG_TIMER_DATE, rtc, sizeof(_DEV_TIMER_DATE_t));
 }
@@ -36,6 +48,23 @@ void draw_sync() {
   _io_write(_DEV_VIDEO, _DEVREG_VIDEO_FBCTRL, &ctl, sizeof(ctl));
 }
 
+// Return the frame buffer which can be drawn directly, or NULL if not supported.
+// Its pitch is screen_width() pixels.
+uint32_t *fb_addr() {
+  _DEV_VIDEO_FBADDR_t fbaddr;
+  fbaddr.pixels = NULL;
+  _io_read(_DEV_VIDEO, _DEVREG_VIDEO_FBADDR, &fbaddr, sizeof(fbaddr));
+  return fbaddr.pixels;
+}
+
+// Tell the device that the region in the frame buffer is modified.
+void fb_present(int x, int y, int w, int h) {
+  _DEV_VIDEO_PRESENT_t present = (_DEV_VIDEO_PRESENT_t) {
+    .x = x, .y = y, .w = w, .h = h,
+  };
+  _io_write(_DEV_VIDEO, _DEVREG_VIDEO_PRESENT, &present, sizeof(present));
+}
+
 int screen_width() {
   _DEV_VIDEO_INFO_t info;
   _io_read(_DEV_VIDEO, _DEVREG_VIDEO_INFO, &info, sizeof(info));
@@ -0,0 +1,261 @@
+#include "klib.h"
+#include <klib-macros.h>
+
+#if !defined(__ISA_NATIVE__) || defined(__NATIVE_USE_KLIB__)
+
+// A size-class allocator for AM programs running on one or more processors.
+//
+// _heap is divided into chunks of CHUNK_SIZE bytes. A chunk either holds
+// objects of a single size class, or belongs to a run of chunks serving one
+// large allocation. The owner of each chunk is recorded in chunk_info[],
+// so objects carry no header.
+//
+// Each processor caches free objects of every size class, so malloc() and
+// free() usually only take the uncontended lock of the local cache. The
+// caches are refilled from and drained to the global free lists in batches
+// under heap_lock.
+//
+// malloc() and free() are not reentrant, so do not call them in interrupt
+// handlers which may preempt them.
+
+#define CHUNK_SIZE   (32 * 1024)
+#define MIN_SHIFT    4           // 16 bytes
+#define NR_CLASS     10          // 16 bytes ~ 8KB
+#define MAX_SMALL    (1 << (MIN_SHIFT + NR_CLASS - 1))
+#define BATCH_BYTES  (8 * 1024)  // bytes moved between the local and global lists
+#define MAX_CPU      64
+#define CHUNK_FREE   (-1)        // chunk_info[] of chunks not in use
+#define CHUNK_TAIL   (-2)        // chunk_info[] of non-head chunks of a large run
+#define CHUNK_RUN(n) (-2 - (int32_t)(n)) // chunk_info[] of the head of a large run of n chunks
+
+typedef struct Obj {
+  struct Obj *next;
+} Obj;
+
+typedef struct Run {
+  struct Run *next;
+  size_t n;  // number of chunks
+} Run;
+
+typedef struct {
+  intptr_t lock;
+  Obj *head[NR_CLASS];
+  int count[NR_CLASS];
+} __attribute__((aligned(64))) Cache;
+
+static Cache caches[MAX_CPU];
+
+static intptr_t heap_lock = 0;
+static volatile int heap_ready = 0;
+static void *base;        // the first chunk
+static size_t nr_chunk;   // number of chunks in _heap
+static size_t next_chunk; // chunks [next_chunk, nr_chunk) have never been used
+static int32_t *chunk_info; // >= 0: size class, < 0: CHUNK_FREE, CHUNK_TAIL or CHUNK_RUN()
+static Run *free_runs;      // freed large runs, sorted by address
+static Obj *global_head[NR_CLASS];
+
+static inline void lock(intptr_t *lk) {
+  while (_atomic_xchg(lk, 1) != 0) ;
+  __sync_synchronize();
+}
+
+static inline void unlock(intptr_t *lk) {
+  __sync_synchronize();
+  _atomic_xchg(lk, 0);
+}
+
+static inline int size2class(size_t size) {
+  if (size <= (1ul << MIN_SHIFT)) return 0;
+  // ceil(log2(size)) - MIN_SHIFT
+  return sizeof(long) * 8 - __builtin_clzl(size - 1) - MIN_SHIFT;
+}
+
+static inline size_t class2size(int c) {
+  return 1ul << (MIN_SHIFT + c);
+}
+
+static inline int batch(int c) {
+  int n = BATCH_BYTES / class2size(c);
+  return (n > 0 ? n : 1);
+}
+
+static inline size_t chunk_idx(void *p) {
+  return (p - base) / CHUNK_SIZE;
+}
+
+static inline void *chunk_addr(size_t idx) {
+  return base + idx * CHUNK_SIZE;
+}
+
+static void heap_init() {
+  lock(&heap_lock);
+  if (!heap_ready) {
+    // chunk_info[] is put at the beginning of the heap
+    size_t n = (_heap.end - _heap.start) / CHUNK_SIZE;
+    chunk_info = _heap.start;
+    base = (void *)ROUNDUP(_heap.start + n * sizeof(chunk_info[0]), CHUNK_SIZE);
+    nr_chunk = (base < _heap.end ? (_heap.end - base) / CHUNK_SIZE : 0);
+    next_chunk = 0;
+    free_runs = NULL;
+    for (size_t i = 0; i < nr_chunk; i ++) chunk_info[i] = CHUNK_FREE;
+    heap_ready = 1;
+  }
+  unlock(&heap_lock);
+}
+
+// allocate n contiguous chunks, called with heap_lock held
+static void *chunk_alloc(size_t n) {
+  // first fit in the freed runs
+  for (Run **pp = &free_runs; *pp != NULL; pp = &(*pp)->next) {
+    Run *r = *pp;
+    if (r->n < n) continue;
+    if (r->n == n) {
+      *pp = r->next;
+      return r;
+    }
+    // take the tail of the run, so that the list is untouched
+    r->n -= n;
+    return (void *)r + r->n * CHUNK_SIZE;
+  }
+
+  if (nr_chunk - next_chunk < n) return NULL;
+  void *p = chunk_addr(next_chunk);
+  next_chunk += n;
+  return p;
+}
+
+// free a run of n chunks, called with heap_lock held
+static void chunk_free(void *p, size_t n) {
+  for (size_t i = 0; i < n; i ++) chunk_info[chunk_idx(p) + i] = CHUNK_FREE;
+
+  Run *prev = NULL, *next = free_runs;
+  while (next != NULL && (void *)next < p) {
+    prev = next;
+    next = next->next;
+  }
+
+  Run *r = p;
+  r->n = n;
+  r->next = next;
+  // merge with the following run
+  if (next != NULL && p + n * CHUNK_SIZE == (void *)next) {
+    r->n += next->n;
+    r->next = next->next;
+  }
+  // merge with the preceding run
+  if (prev != NULL && (void *)prev + prev->n * CHUNK_SIZE == p) {
+    prev->n += r->n;
+    prev->next = r->next;
+  } else if (prev != NULL) {
+    prev->next = r;
+  } else {
+    free_runs = r;
+  }
+}
+
+// move up to `max` objects of class c from the global list to the
+// local cache, carving a new chunk if needed
+static void refill(Cache *cache, int c, int max) {
+  lock(&heap_lock);
+  if (global_head[c] == NULL) {
+    void *p = chunk_alloc(1);
+    if (p != NULL) {
+      chunk_info[chunk_idx(p)] = c;
+      size_t size = class2size(c);
+      Obj *head = NULL;
+      for (void *q = p + CHUNK_SIZE - size; q >= p; q -= size) {
+        ((Obj *)q)->next = head;
+        head = q;
+      }
+      global_head[c] = head;
+    }
+  }
+
+  int n = 0;
+  Obj *obj = global_head[c];
+  while (obj != NULL && n < max) {
+    Obj *next = obj->next;
+    obj->next = cache->head[c];
+    cache->head[c] = obj;
+    obj = next;
+    n ++;
+  }
+  global_head[c] = obj;
+  cache->count[c] += n;
+  unlock(&heap_lock);
+}
+
+// move `n` objects of class c from the local cache to the global list
+static void drain(Cache *cache, int c, int n) {
+  Obj *first = cache->head[c], *last = first;
+  for (int i = 1; i < n; i ++) last = last->next;
+  cache->head[c] = last->next;
+  cache->count[c] -= n;
+
+  lock(&heap_lock);
+  last->next = global_head[c];
+  global_head[c] = first;
+  unlock(&heap_lock);
+}
+
+static void *large_alloc(size_t size) {
+  // also keeps the rounding below from wrapping to 0 chunks
+  if (size > nr_chunk * CHUNK_SIZE) return NULL;
+  size_t n = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  lock(&heap_lock);
+  void *p = chunk_alloc(n);
+  if (p != NULL) {
+    size_t idx = chunk_idx(p);
+    chunk_info[idx] = CHUNK_RUN(n);
+    for (size_t i = 1; i < n; i ++) chunk_info[idx + i] = CHUNK_TAIL;
+  }
+  unlock(&heap_lock);
+  return p;
+}
+
+void *malloc(size_t size) {
+  if (!heap_ready) heap_init();
+
+  if (size > MAX_SMALL) return large_alloc(size);
+
+  int c = size2class(size);
+  Cache *cache = &caches[_cpu() % MAX_CPU];
+  lock(&cache->lock);
+  if (cache->head[c] == NULL) refill(cache, c, batch(c));
+  Obj *obj = cache->head[c];
+  if (obj != NULL) {
+    cache->head[c] = obj->next;
+    cache->count[c] --;
+  }
+  unlock(&cache->lock);
+  return obj;
+}
+
+void free(void *ptr) {
+  if (ptr == NULL) return;
+  assert(heap_ready && ptr >= base && ptr < chunk_addr(nr_chunk));
+
+  int32_t info = chunk_info[chunk_idx(ptr)];
+  assert(info != CHUNK_FREE && info != CHUNK_TAIL);
+
+  if (info < 0) {
+    assert(ptr == chunk_addr(chunk_idx(ptr)));
+    lock(&heap_lock);
+    chunk_free(ptr, CHUNK_RUN(0) - info);
+    unlock(&heap_lock);
+    return;
+  }
+
+  int c = info;
+  Cache *cache = &caches[_cpu() % MAX_CPU];
+  lock(&cache->lock);
+  Obj *obj = ptr;
+  obj->next = cache->head[c];
+  cache->head[c] = obj;
+  cache->count[c] ++;
+  // keep at most two batches locally
+  if (cache->count[c] > 2 * batch(c)) drain(cache, c, batch(c));
+  unlock(&cache->lock);
+}
+
+#endif
@@ -0,0 +1,74 @@
+#include <klib.h>
+#include <klib-macros.h>
+#include <new>
+
+#ifndef __ISA_NATIVE__
+
+// operator new and delete on top of the klib allocator. Exceptions are
+// disabled, so running out of memory is fatal instead of throwing
+// std::bad_alloc, except for the nothrow versions.
+
+static void *alloc(size_t size) {
+  return malloc(size == 0 ? 1 : size);
+}
+
+static void *alloc_or_panic(size_t size) {
+  void *p = alloc(size);
+  panic_on(p == NULL, "operator new: out of memory");
+  return p;
+}
+
+void *operator new(size_t size) { return alloc_or_panic(size); }
+void *operator new[](size_t size) { return alloc_or_panic(size); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return alloc(size); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return alloc(size); }
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { free(p); }
+
+#if __cpp_aligned_new
+// Over-aligned objects: allocate extra space and keep the pointer
+// returned by malloc() right below the aligned object.
+
+static void *alloc_aligned(size_t size, std::align_val_t al) {
+  size_t align = (size_t)al;
+  if (align < sizeof(void *)) align = sizeof(void *);
+  void *raw = alloc(size + align + sizeof(void *));
+  if (raw == NULL) return NULL;
+  void **p = (void **)ROUNDUP((uintptr_t)raw + sizeof(void *), align);
+  p[-1] = raw;
+  return p;
+}
+
+static void *alloc_aligned_or_panic(size_t size, std::align_val_t al) {
+  void *p = alloc_aligned(size, al);
+  panic_on(p == NULL, "operator new: out of memory");
+  return p;
+}
+
+static void free_aligned(void *p) {
+  if (p != NULL) free(((void **)p)[-1]);
+}
+
+void *operator new(size_t size, std::align_val_t al) { return alloc_aligned_or_panic(size, al); }
+void *operator new[](size_t size, std::align_val_t al) { return alloc_aligned_or_panic(size, al); }
+void *operator new(size_t size, std::align_val_t al, const std::nothrow_t &) noexcept {
+  return alloc_aligned(size, al);
+}
+void *operator new[](size_t size, std::align_val_t al, const std::nothrow_t &) noexcept {
+  return alloc_aligned(size, al);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept { free_aligned(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { free_aligned(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept { free_aligned(p); }
+void operator delete[](void *p, size_t, std::align_val_t) noexcept { free_aligned(p); }
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept { free_aligned(p); }
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept { free_aligned(p); }
+#endif
+
+#endif
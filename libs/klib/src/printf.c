@@ -155,6 +155,89 @@ static inline void _out_char(char character, void* buffer, size_t idx, size_t ma
 }
 
 
+// Output of printf() is collected in a per-CPU line buffer, and written with
+// a single _putstr() on newline and when the buffer is full. With a single
+// CPU, it is also written at the end of each call, so nothing is left in the
+// buffer when the program halts. With more CPUs, partial lines are kept, so
+// that lines from different CPUs are never mixed up.
+#ifndef PRINTF_LINE_BUFFER_SIZE
+#define PRINTF_LINE_BUFFER_SIZE    128U
+#endif
+#define PRINTF_MAX_CPU             64
+
+// define this globally (e.g. gcc -DPRINTF_CPU_PREFIX ...) to start every
+// line with "[cpuN] " when there is more than one CPU
+// default: undefined
+
+typedef struct {
+  char buf[PRINTF_LINE_BUFFER_SIZE];
+  size_t len;
+  bool mid_line;  // the last character written is not '\n'
+  volatile int busy;
+} line_buffer_type;
+
+static line_buffer_type _line_buffer[PRINTF_MAX_CPU];
+
+// serializes lines written by different CPUs
+static intptr_t _output_lock = 0;
+
+
+// fallback for the platforms without _putstr()
+__attribute__((weak)) void _putstr(const char* s, size_t len)
+{
+  while (len--) {
+    _putc(*s++);
+  }
+}
+
+
+// write out the buffer, holding _output_lock which is already taken
+static inline void _line_write(line_buffer_type* lb)
+{
+  __sync_synchronize();
+  _putstr(lb->buf, lb->len);
+  __sync_synchronize();
+  _atomic_xchg(&_output_lock, 0);
+  lb->mid_line = (lb->buf[lb->len - 1] != '\n');
+  lb->len = 0U;
+}
+
+
+static inline void _line_flush(line_buffer_type* lb)
+{
+  if (lb->len) {
+    while (_atomic_xchg(&_output_lock, 1) != 0);
+    _line_write(lb);
+  }
+}
+
+
+// internal line buffer output
+static inline void _out_line(char character, void* buffer, size_t idx, size_t maxlen)
+{
+  (void)idx; (void)maxlen;
+  line_buffer_type* lb = (line_buffer_type*)buffer;
+  if (character) {
+#if defined(PRINTF_CPU_PREFIX)
+    if ((lb->len == 0U) && !lb->mid_line && (_ncpu() > 1)) {
+      const int cpu = _cpu();
+      const char prefix[] = { '[', 'c', 'p', 'u', '0' + cpu / 10 % 10, '0' + cpu % 10, ']', ' ' };
+      // skip the leading zero of one-digit CPU IDs
+      for (size_t i = 0U; i < sizeof(prefix); i++) {
+        if ((i != 4U) || (cpu >= 10)) {
+          lb->buf[lb->len++] = prefix[i];
+        }
+      }
+    }
+#endif
+    lb->buf[lb->len++] = character;
+    if ((character == '\n') || (lb->len == PRINTF_LINE_BUFFER_SIZE)) {
+      _line_flush(lb);
+    }
+  }
+}
+
+
 // internal output function wrapper
 static inline void _out_fct(char character, void* buffer, size_t idx, size_t maxlen)
 {
@@ -277,6 +360,76 @@ static size_t _ntoa_format(out_fct_type out, char* buffer, size_t idx, size_t ma
 }
 
 
+// two-digit lookup table for decimal conversion
+static const char _dec_pairs[200] = {
+  '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+  '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+  '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+  '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+  '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+  '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+  '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+  '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+  '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+  '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9',
+};
+
+
+// internal decimal conversion of a 32-bit value, digits are written in reverse
+// the divisions by constants are turned into multiplications by the compiler
+static inline size_t _utoa32_dec_rev(char* buf, uint32_t value, size_t min_digits)
+{
+  size_t len = 0U;
+  while (value >= 100U) {
+    const uint32_t q = value / 100U;
+    const uint32_t r = value - q * 100U;
+    buf[len++] = _dec_pairs[2U * r + 1U];
+    buf[len++] = _dec_pairs[2U * r];
+    value = q;
+  }
+  if (value >= 10U) {
+    buf[len++] = _dec_pairs[2U * value + 1U];
+    buf[len++] = _dec_pairs[2U * value];
+  }
+  else {
+    buf[len++] = (char)('0' + value);
+  }
+  while (len < min_digits) {
+    buf[len++] = '0';
+  }
+  return len;
+}
+
+
+// internal unsigned conversion, digits are written in reverse
+// \return The number of digits
+static size_t _utoa_rev(char* buf, unsigned long long value, unsigned int base, unsigned int flags)
+{
+  size_t len = 0U;
+
+  if (base != 10U) {
+    // 2, 8 and 16 need no division at all
+    const unsigned int shift = (base == 16U) ? 4U : ((base == 8U) ? 3U : 1U);
+    const char a = (flags & FLAGS_UPPERCASE) ? 'A' : 'a';
+    do {
+      const char digit = (char)(value & (base - 1U));
+      buf[len++] = digit < 10 ? '0' + digit : a + digit - 10;
+      value >>= shift;
+    } while (value && (len < PRINTF_NTOA_BUFFER_SIZE));
+    return len;
+  }
+
+  // cut large values into chunks of 9 digits, so that there is only one
+  // 64-bit division per chunk, and the rest is done in 32 bits
+  while (value > 0xffffffffULL) {
+    const unsigned long long q = value / 1000000000U;
+    len += _utoa32_dec_rev(buf + len, (uint32_t)(value - q * 1000000000U), 9U);
+    value = q;
+  }
+  return len + _utoa32_dec_rev(buf + len, (uint32_t)value, 0U);
+}
+
+
 // internal itoa for 'long' type
 static size_t _ntoa_long(out_fct_type out, char* buffer, size_t idx, size_t maxlen, unsigned long value, bool negative, unsigned long base, unsigned int prec, unsigned int width, unsigned int flags)
 {
@@ -290,11 +443,7 @@ static size_t _ntoa_long(out_fct_type out, char* buffer, size_t idx, size_t maxl
 
   // write if precision != 0 and value is != 0
   if (!(flags & FLAGS_PRECISION) || value) {
-    do {
-      const char digit = (char)(value % base);
-      buf[len++] = digit < 10 ? '0' + digit : (flags & FLAGS_UPPERCASE ? 'A' : 'a') + digit - 10;
-      value /= base;
-    } while (value && (len < PRINTF_NTOA_BUFFER_SIZE));
+    len = _utoa_rev(buf, value, (unsigned int)base, flags);
   }
 
   return _ntoa_format(out, buffer, idx, maxlen, buf, len, negative, (unsigned int)base, prec, width, flags);
@@ -315,11 +464,7 @@ static size_t _ntoa_long_long(out_fct_type out, char* buffer, size_t idx, size_t
 
   // write if precision != 0 and value is != 0
   if (!(flags & FLAGS_PRECISION) || value) {
-    do {
-      const char digit = (char)(value % base);
-      buf[len++] = digit < 10 ? '0' + digit : (flags & FLAGS_UPPERCASE ? 'A' : 'a') + digit - 10;
-      value /= base;
-    } while (value && (len < PRINTF_NTOA_BUFFER_SIZE));
+    len = _utoa_rev(buf, value, (unsigned int)base, flags);
   }
 
   return _ntoa_format(out, buffer, idx, maxlen, buf, len, negative, (unsigned int)base, prec, width, flags);
@@ -857,14 +1002,53 @@ static int _vsnprintf(out_fct_type out, char* buffer, const size_t maxlen, const
 }
 
 
+static int _vprintf(const char* format, va_list va)
+{
+  line_buffer_type* lb = &_line_buffer[_cpu() % PRINTF_MAX_CPU];
+  if (lb->busy) {
+    // reentered on this CPU, e.g. by an interrupt handler, so bypass the buffer
+    char buffer[1];
+    return _vsnprintf(_out_char, buffer, (size_t)-1, format, va);
+  }
+  lb->busy = 1;
+  const int ret = _vsnprintf(_out_line, (char*)lb, (size_t)-1, format, va);
+  if (_ncpu() == 1) {
+    _line_flush(lb);
+  }
+  lb->busy = 0;
+  return ret;
+}
+
+
+// called by _halt(): write out the partial lines left in the buffers of all
+// CPUs, skipping those still being filled by a printf() in progress.
+// _halt() may be reached from a trap taken while this CPU holds
+// _output_lock, so give up after a bounded wait instead of deadlocking.
+#define PRINTF_FLUSH_TRIES 1000000
+
+void __printf_flush(void)
+{
+  for (size_t i = 0U; i < PRINTF_MAX_CPU; i++) {
+    line_buffer_type* lb = &_line_buffer[i];
+    if (!lb->busy && lb->len) {
+      int tries = PRINTF_FLUSH_TRIES;
+      while ((_atomic_xchg(&_output_lock, 1) != 0) && (--tries > 0));
+      if (tries == 0) {
+        return;
+      }
+      _line_write(lb);
+    }
+  }
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 #ifndef NOPRINT
 int printf_(const char* format, ...)
 {
   va_list va;
   va_start(va, format);
-  char buffer[1];
-  const int ret = _vsnprintf(_out_char, buffer, (size_t)-1, format, va);
+  const int ret = _vprintf(format, va);
   va_end(va);
   return ret;
 }
@@ -898,8 +1082,7 @@ int snprintf_(char* buffer, size_t count, const char* format, ...)
 
 int vprintf_(const char* format, va_list va)
 {
-  char buffer[1];
-  return _vsnprintf(_out_char, buffer, (size_t)-1, format, va);
+  return _vprintf(format, va);
 }
 
 
@@ -1,5 +1,6 @@
 #include "klib.h"
 #include <klib-macros.h>
+#include <limits.h>
 
 #if !defined(__ISA_NATIVE__) || defined(__NATIVE_USE_KLIB__)
 static unsigned long int next = 1;
@@ -28,30 +29,190 @@ int atoi(const char* nptr) {
   return x;
 }
 
-static struct {
-  void *ptr;
-  uintptr_t size;
-} last = { .ptr = NULL, .size = 0 };
+static inline int is_space(char c) {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static inline int digit_value(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'z') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'Z') return c - 'A' + 10;
+  return 36;
+}
+
+// Parse the magnitude for strtol() and strtoul(). Values out of the range
+// are clamped to `limit` and reported by `*overflow`, since there is no
+// errno in klib.
+static unsigned long parse_ulong(const char *nptr, char **endptr, int base,
+    unsigned long limit, int *neg, int *overflow) {
+  *neg = 0;
+  *overflow = 0;
+  if (base < 0 || base == 1 || base > 36) {
+    // invalid base: no conversion
+    if (endptr != NULL) *endptr = (char *)nptr;
+    return 0;
+  }
+
+  const char *s = nptr;
+  while (is_space(*s)) s ++;
+  if (*s == '+' || *s == '-') { *neg = (*s == '-'); s ++; }
+
+  if ((base == 0 || base == 16) && s[0] == '0' && (s[1] == 'x' || s[1] == 'X') &&
+      digit_value(s[2]) < 16) {
+    s += 2;
+    base = 16;
+  } else if (base == 0) {
+    base = (s[0] == '0' ? 8 : 10);
+  }
+
+  unsigned long x = 0;
+  int any = 0;
+  for (int d; (d = digit_value(*s)) < base; s ++) {
+    any = 1;
+    if (x > (limit - d) / base) *overflow = 1;
+    else x = x * base + d;
+  }
+
+  if (endptr != NULL) *endptr = (char *)(any ? s : nptr);
+  return (*overflow ? limit : x);
+}
+
+long strtol(const char *nptr, char **endptr, int base) {
+  int neg, overflow;
+  // the magnitude of LONG_MIN is LONG_MAX + 1
+  unsigned long x = parse_ulong(nptr, endptr, base, (unsigned long)LONG_MAX + 1, &neg, &overflow);
+  if (!neg) return (x > LONG_MAX ? LONG_MAX : (long)x);
+  return (x == (unsigned long)LONG_MAX + 1 ? LONG_MIN : -(long)x);
+}
+
+unsigned long strtoul(const char *nptr, char **endptr, int base) {
+  int neg, overflow;
+  unsigned long x = parse_ulong(nptr, endptr, base, ULONG_MAX, &neg, &overflow);
+  return (neg && !overflow ? -x : x);
+}
+
+// qsort() is an introsort: quicksort with median-of-three pivots, falling
+// back to heapsort when the recursion gets too deep, and insertion sort
+// for short ranges. Elements are swapped in the widest aligned unit.
+
+#define QSORT_CUTOFF 16
+
+typedef int (*cmp_t)(const void *, const void *);
+enum { SWAP_LONG, SWAP_LONGS, SWAP_INT, SWAP_BYTES };
 
-void *malloc(size_t size) {
-  if (last.ptr == NULL) {
-    last.ptr = _heap.start;
-    printf("heap start = %x\n", last.ptr);
+static int swap_type(void *base, size_t size) {
+  if ((uintptr_t)base % sizeof(long) == 0 && size % sizeof(long) == 0) {
+    return (size == sizeof(long) ? SWAP_LONG : SWAP_LONGS);
   }
+  if ((uintptr_t)base % sizeof(int) == 0 && size == sizeof(int)) return SWAP_INT;
+  return SWAP_BYTES;
+}
+
+static inline void swap(char *a, char *b, size_t size, int type) {
+  switch (type) {
+    case SWAP_LONG: { long t = *(long *)a; *(long *)a = *(long *)b; *(long *)b = t; break; }
+    case SWAP_INT:  { int  t = *(int  *)a; *(int  *)a = *(int  *)b; *(int  *)b = t; break; }
+    case SWAP_LONGS:
+      for (long *p = (long *)a, *q = (long *)b; size > 0; size -= sizeof(long), p ++, q ++) {
+        long t = *p; *p = *q; *q = t;
+      }
+      break;
+    default:
+      for (; size > 0; size --, a ++, b ++) {
+        char t = *a; *a = *b; *b = t;
+      }
+  }
+}
+
+static void insertion_sort(char *base, size_t n, size_t size, cmp_t cmp, int type) {
+  for (char *i = base + size; i < base + n * size; i += size) {
+    for (char *j = i; j > base && cmp(j - size, j) > 0; j -= size) {
+      swap(j, j - size, size, type);
+    }
+  }
+}
 
-  // aligning
-  size = ROUNDUP(size, sizeof(uintptr_t));
+static void sift_down(char *base, size_t root, size_t n, size_t size, cmp_t cmp, int type) {
+  size_t child;
+  while ((child = 2 * root + 1) < n) {
+    if (child + 1 < n && cmp(base + child * size, base + (child + 1) * size) < 0) child ++;
+    if (cmp(base + root * size, base + child * size) >= 0) return;
+    swap(base + root * size, base + child * size, size, type);
+    root = child;
+  }
+}
 
-  // skip the region allocated by the last call
-  last.ptr += last.size;
-  if (last.ptr + size >= _heap.end) return NULL;
-  void *ret = last.ptr;
-  last.size = size;
-  return ret;
+static void heap_sort(char *base, size_t n, size_t size, cmp_t cmp, int type) {
+  for (size_t i = n / 2; i > 0; i --) sift_down(base, i - 1, n, size, cmp, type);
+  for (size_t i = n - 1; i > 0; i --) {
+    swap(base, base + i * size, size, type);
+    sift_down(base, 0, i, size, cmp, type);
+  }
 }
 
-void free(void *ptr) {
-  if (ptr == last.ptr) last.size = 0;
+static void introsort(char *base, size_t n, size_t size, cmp_t cmp, int type, int depth) {
+  while (n > QSORT_CUTOFF) {
+    if (depth -- == 0) {
+      heap_sort(base, n, size, cmp, type);
+      return;
+    }
+
+    // sort lo, mid and hi, then use the median as the pivot at lo,
+    // so that hi stops the scan from the left
+    char *lo = base, *mid = base + (n / 2) * size, *hi = base + (n - 1) * size;
+    if (cmp(mid, lo) < 0) swap(mid, lo, size, type);
+    if (cmp(hi, mid) < 0) {
+      swap(hi, mid, size, type);
+      if (cmp(mid, lo) < 0) swap(mid, lo, size, type);
+    }
+    swap(lo, mid, size, type);
+
+    // Hoare partition, stopping at elements equal to the pivot
+    char *i = lo, *j = hi + size;
+    while (1) {
+      do { i += size; } while (cmp(i, lo) < 0);
+      do { j -= size; } while (cmp(j, lo) > 0);
+      if (i >= j) break;
+      swap(i, j, size, type);
+    }
+    swap(lo, j, size, type);
+
+    // recurse into the smaller part, and loop on the larger one
+    size_t nl = (j - base) / size, nr = n - nl - 1;
+    if (nl < nr) {
+      introsort(base, nl, size, cmp, type, depth);
+      base = j + size;
+      n = nr;
+    } else {
+      introsort(j + size, nr, size, cmp, type, depth);
+      n = nl;
+    }
+  }
+  insertion_sort(base, n, size, cmp, type);
+}
+
+void qsort(void *base, size_t nmemb, size_t size, int (*compar)(const void *, const void *)) {
+  if (nmemb < 2 || size == 0) return;
+  int depth = 0;
+  for (size_t n = nmemb; n > 1; n >>= 1) depth += 2;
+  introsort(base, nmemb, size, compar, swap_type(base, size), depth);
+}
+
+void *bsearch(const void *key, const void *base, size_t nmemb, size_t size,
+    int (*compar)(const void *, const void *)) {
+  const char *lo = base;
+  while (nmemb > 0) {
+    const char *mid = lo + (nmemb / 2) * size;
+    int r = compar(key, mid);
+    if (r == 0) return (void *)mid;
+    if (r > 0) {
+      lo = mid + size;
+      nmemb -= nmemb / 2 + 1;
+    } else {
+      nmemb /= 2;
+    }
+  }
+  return NULL;
 }
 
 #endif
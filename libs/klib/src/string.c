@@ -2,45 +2,148 @@
 
 #if !defined(__ISA_NATIVE__) || defined(__NATIVE_USE_KLIB__)
 
-size_t strlen(const char *s) {
-  size_t sz = 0;
-  for (; *s; s ++) {
-    sz ++;
+// Word-at-a-time helpers. Loads are always aligned, so reading past the
+// terminating '\0' never crosses a page boundary.
+typedef uintptr_t __attribute__((may_alias)) word_t;
+#define WSIZE sizeof(word_t)
+#define ONES  ((word_t)-1 / 0xff)    // 0x0101...01
+#define HIGHS (ONES * 0x80)          // 0x8080...80
+// non-zero iff some byte of x is zero
+#define HAS_ZERO(x) (((x) - ONES) & ~(x) & HIGHS)
+#define IS_ALIGNED(p) ((uintptr_t)(p) % WSIZE == 0)
+
+// length of s, but at most n
+static size_t strnlen_(const char *s, size_t n) {
+  const char *p = s;
+  for (; !IS_ALIGNED(p); p ++, n --) {
+    if (n == 0 || *p == '\0') return p - s;
   }
-  return sz;
+  for (; n >= WSIZE && !HAS_ZERO(*(word_t *)p); p += WSIZE, n -= WSIZE) ;
+  for (; n > 0 && *p != '\0'; p ++, n --) ;
+  return p - s;
+}
+
+size_t strlen(const char *s) {
+  return strnlen_(s, (size_t)-1);
 }
 
 char *strcpy(char* dst,const char* src) {
-  char *ret;
-  ret = dst;
-  while((*dst++=*src++)!='\0');
-  return ret;
+  if ((uintptr_t)(dst - src) % WSIZE != 0) {
+    // mutually misaligned, let memcpy() handle it
+    return memcpy(dst, src, strlen(src) + 1);
+  }
+
+  char *d = dst;
+  for (; !IS_ALIGNED(src); src ++, d ++) {
+    if ((*d = *src) == '\0') return dst;
+  }
+  for (; !HAS_ZERO(*(word_t *)src); src += WSIZE, d += WSIZE) {
+    *(word_t *)d = *(word_t *)src;
+  }
+  while ((*d++ = *src++) != '\0') ;
+  return dst;
 }
+
 char* strncpy(char* dst, const char* src, size_t n){
-  char* ret;
-  ret=dst;
-  while(n-->0){
-    *dst++=*src++;
-  }
-  return ret;
+  size_t len = strnlen_(src, n);
+  memcpy(dst, src, len);
+  memset(dst + len, 0, n - len);
+  return dst;
 }
 
 char* strcat(char* dst, const char* src){
-  char* d=dst;
-  while(*dst!='\0')
-    dst++;
-  while((*dst++=*src++)!='\0');
-  return d;
+  strcpy(dst + strlen(dst), src);
+  return dst;
+}
+
+// compare at most n bytes
+static int strncmp_(const char* s1, const char* s2, size_t n) {
+  const unsigned char *p1 = (const void *)s1, *p2 = (const void *)s2;
+  if ((uintptr_t)(p1 - p2) % WSIZE == 0) {
+    for (; n > 0 && !IS_ALIGNED(p1); p1 ++, p2 ++, n --) {
+      if (*p1 != *p2 || *p1 == '\0') return *p1 - *p2;
+    }
+    // stop at the word with a difference or a '\0', and find it byte by byte
+    for (; n >= WSIZE; p1 += WSIZE, p2 += WSIZE, n -= WSIZE) {
+      word_t w1 = *(word_t *)p1;
+      if (w1 != *(word_t *)p2 || HAS_ZERO(w1)) break;
+    }
+  }
+  for (; n > 0; p1 ++, p2 ++, n --) {
+    if (*p1 != *p2 || *p1 == '\0') return *p1 - *p2;
+  }
+  return 0;
 }
+
 int strcmp(const char* s1, const char* s2){
-  while(*s1&&*s1==*s2)s1++,s2++;
-  return (int)(*s1-*s2);
+  return strncmp_(s1, s2, (size_t)-1);
 }
+
 int strncmp(const char* s1, const char* s2, size_t n){
-  while(--n>0&&*s1&&*s1==*s2)s1++,s2++;
-  return (int)(*s1-*s2);
+  return strncmp_(s1, s2, n);
+}
+
+char *strchr(const char *s, int c) {
+  c = (unsigned char)c;
+  for (; !IS_ALIGNED(s); s ++) {
+    if ((unsigned char)*s == c) return (char *)s;
+    if (*s == '\0') return NULL;
+  }
+  // stop at the word with either c or '\0'
+  word_t mask = ONES * c;
+  for (; ; s += WSIZE) {
+    word_t w = *(word_t *)s;
+    if (HAS_ZERO(w) || HAS_ZERO(w ^ mask)) break;
+  }
+  for (; (unsigned char)*s != c; s ++) {
+    if (*s == '\0') return NULL;
+  }
+  return (char *)s;
 }
 
+char *strrchr(const char *s, int c) {
+  const char *last = NULL;
+  if ((char)c == '\0') return (char *)s + strlen(s);
+  while ((s = strchr(s, c)) != NULL) {
+    last = s ++;
+  }
+  return (char *)last;
+}
+
+char *strstr(const char *haystack, const char *needle) {
+  size_t n = strlen(needle);
+  if (n == 0) return (char *)haystack;
+  // use strchr() to skip to the candidates quickly
+  for (const char *s = haystack; (s = strchr(s, needle[0])) != NULL; s ++) {
+    if (strncmp(s, needle, n) == 0) return (char *)s;
+  }
+  return NULL;
+}
+
+static inline int in_set(char c, const char *set) {
+  for (; *set; set ++) {
+    if (*set == c) return 1;
+  }
+  return 0;
+}
+
+char *strtok(char* s, const char* delim) {
+  static char *next = NULL;
+  if (s == NULL) s = next;
+  if (s == NULL) return NULL;
+
+  while (*s && in_set(*s, delim)) s ++;
+  if (*s == '\0') {
+    next = NULL;
+    return NULL;
+  }
+
+  char *tok = s;
+  while (*s && !in_set(*s, delim)) s ++;
+  if (*s) *s ++ = '\0';
+  next = (*s ? s : NULL);
+  return tok;
+}
 
 void* memset(void* v,int c,size_t n){
   c &= 0xff;
@@ -80,21 +183,17 @@ void* memset(void* v,int c,size_t n){
   return v;
 }
 
-void* memmove(void* dst,const void* src,size_t n){
-  const char* s;
-  char* d;
-  if(src+n>dst&&src<dst){
-    s=src+n;
-    d=dst+n;
-    while(n-->0)*--d=*--s;
-  }
-  else{
-    memcpy(dst, src, n);
-  }
-  return dst;
-}
+// How memcpy() and memmove() handle mutually misaligned buffers. x86 handles misaligned
+// loads in hardware, while other ISAs may trap or emulate them, so aligned
+// loads are merged with shifts there.
+#if defined(__ISA_X86__) || defined(__ISA_X86_64__) || defined(__ISA_NATIVE__)
+#define MEMCPY_UNALIGNED_LOAD
+#endif
 
-void* memcpy(void* out, const void* in, size_t n) {
+// Copy from low addresses to high addresses. Every word is loaded before
+// the store which may overwrite it, so this is also safe for overlapping
+// buffers with dst < src.
+static void copy_forward(void* out, const void* in, size_t n) {
   char *dst = (char *)out;
   char *src = (char *)in;
   const size_t threshold = 32;
@@ -160,15 +259,130 @@ void* memcpy(void* out, const void* in, size_t n) {
     src = (void *)src4;
   }
 
+  if (n >= threshold) {
+    // dst and src are mutually misaligned, first let dst aligned
+    int pad = (WSIZE - (uintptr_t)dst % WSIZE) % WSIZE;
+    n -= pad;
+    while (pad --) { *dst ++ = *src ++; }
+
+    word_t *dstw = (void *)dst;
+#ifdef MEMCPY_UNALIGNED_LOAD
+    typedef word_t __attribute__((aligned(1))) uword_t;
+    uword_t *srcw = (void *)src;
+    while (n >= WSIZE) {
+      *dstw ++ = *srcw ++;
+      n -= WSIZE;
+    }
+    src = (void *)srcw;
+#else
+    // each word of dst is merged from two adjacent aligned words of src
+    int shift = (uintptr_t)src % WSIZE;
+    int rs = shift * 8, ls = WSIZE * 8 - rs;
+    word_t *srcw = (void *)(src - shift);
+    word_t w = *srcw ++;
+    while (n >= WSIZE) {
+      word_t next = *srcw ++;
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      *dstw ++ = (w << rs) | (next >> ls);
+#else
+      *dstw ++ = (w >> rs) | (next << ls);
+#endif
+      w = next;
+      n -= WSIZE;
+    }
+    src = (char *)srcw - WSIZE + shift;
+#endif
+    dst = (void *)dstw;
+  }
+
   while (n--) { *dst++ = *src++; }
+}
+
+// Copy from high addresses to low addresses, which is safe for overlapping
+// buffers with dst > src.
+static void copy_backward(void* out, const void* in, size_t n) {
+  char *dst = (char *)out + n;
+  char *src = (char *)in + n;
+
+  if (n >= 32) {
+    // first let the end of dst aligned
+    int pad = (uintptr_t)dst % WSIZE;
+    n -= pad;
+    while (pad --) { *-- dst = *-- src; }
+
+    word_t *dstw = (void *)dst;
+    if ((uintptr_t)src % WSIZE == 0) {
+      word_t *srcw = (void *)src;
+      while (n >= 4 * WSIZE) {
+        dstw[-1] = srcw[-1];
+        dstw[-2] = srcw[-2];
+        dstw[-3] = srcw[-3];
+        dstw[-4] = srcw[-4];
+        dstw -= 4; srcw -= 4;
+        n -= 4 * WSIZE;
+      }
+      while (n >= WSIZE) {
+        *-- dstw = *-- srcw;
+        n -= WSIZE;
+      }
+      src = (void *)srcw;
+    } else {
+#ifdef MEMCPY_UNALIGNED_LOAD
+      typedef word_t __attribute__((aligned(1))) uword_t;
+      uword_t *srcw = (void *)src;
+      while (n >= WSIZE) {
+        *-- dstw = *-- srcw;
+        n -= WSIZE;
+      }
+      src = (void *)srcw;
+#else
+      // each word of dst is merged from two adjacent aligned words of src
+      int shift = (uintptr_t)src % WSIZE;
+      int rs = shift * 8, ls = WSIZE * 8 - rs;
+      word_t *srcw = (void *)(src - shift);
+      word_t w = *srcw;
+      while (n >= WSIZE) {
+        word_t prev = *-- srcw;
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        *-- dstw = (prev << rs) | (w >> ls);
+#else
+        *-- dstw = (prev >> rs) | (w << ls);
+#endif
+        w = prev;
+        n -= WSIZE;
+      }
+      src = (char *)srcw + shift;
+#endif
+    }
+    dst = (void *)dstw;
+  }
+
+  while (n--) { *-- dst = *-- src; }
+}
+
+void* memcpy(void* out, const void* in, size_t n) {
+  copy_forward(out, in, n);
   return out;
 }
 
+void* memmove(void* dst, const void* src, size_t n) {
+  if (dst < src || dst >= src + n) copy_forward(dst, src, n);
+  else if (dst != src) copy_backward(dst, src, n);
+  return dst;
+}
+
 int memcmp(const void* s1, const void* s2, size_t n){
-  const char *t1 = s1;
-  const char *t2 = s2;
-  while(--n>0&&*t1==*t2)t1++,t2++;
-  return (int)(*t1-*t2);
+  const unsigned char *p1 = s1, *p2 = s2;
+  if ((uintptr_t)(p1 - p2) % WSIZE == 0) {
+    for (; n > 0 && !IS_ALIGNED(p1); p1 ++, p2 ++, n --) {
+      if (*p1 != *p2) return *p1 - *p2;
+    }
+    for (; n >= WSIZE && *(word_t *)p1 == *(word_t *)p2; p1 += WSIZE, p2 += WSIZE, n -= WSIZE) ;
+  }
+  for (; n > 0; p1 ++, p2 ++, n --) {
+    if (*p1 != *p2) return *p1 - *p2;
+  }
+  return 0;
 }
 
 #endif
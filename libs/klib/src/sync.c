@@ -0,0 +1,156 @@
+#include <klib.h>
+#include <klib-macros.h>
+
+// Atomics, spinlocks and a barrier for the CPUs started by _mpe_init().
+// Unlike _atomic_xchg(), which is a no-op on single-core platforms, these
+// are implemented here and work everywhere: with AMOs on riscv, with
+// lock-prefixed cmpxchg/xadd on x86 (written in asm, since gcc does not
+// emit these i486 instructions for -march=i386), and with compiler atomics
+// elsewhere.
+// All of them are full memory barriers.
+
+#define MAX_CPU     64
+#define LOG_MAX_CPU 6
+#define CACHE_LINE  64
+
+#if defined(__ISA_RISCV32__) || defined(__ISA_RISCV64__)
+#if __riscv_xlen == 64
+#define AMO(op) op ".d.aqrl"
+#else
+#define AMO(op) op ".w.aqrl"
+#endif
+
+intptr_t sync_cas(volatile intptr_t *addr, intptr_t expect, intptr_t newval) {
+  intptr_t old, fail;
+  asm volatile(
+    "1: " AMO("lr") " %0, %2;"
+    "   bne %0, %3, 2f;"
+    "   " AMO("sc") " %1, %4, %2;"
+    "   bnez %1, 1b;"
+    "2:"
+    : "=&r"(old), "=&r"(fail), "+A"(*addr)
+    : "r"(expect), "r"(newval)
+    : "memory"
+  );
+  return old;
+}
+
+intptr_t sync_xchg(volatile intptr_t *addr, intptr_t newval) {
+  intptr_t old;
+  asm volatile(AMO("amoswap") " %0, %2, %1;" : "=r"(old), "+A"(*addr) : "r"(newval) : "memory");
+  return old;
+}
+
+intptr_t sync_fetch_add(volatile intptr_t *addr, intptr_t val) {
+  intptr_t old;
+  asm volatile(AMO("amoadd") " %0, %2, %1;" : "=r"(old), "+A"(*addr) : "r"(val) : "memory");
+  return old;
+}
+
+#elif defined(__ISA_X86__)
+
+intptr_t sync_cas(volatile intptr_t *addr, intptr_t expect, intptr_t newval) {
+  intptr_t old;
+  asm volatile("lock cmpxchgl %2, %1" : "=a"(old), "+m"(*addr) : "r"(newval), "0"(expect) : "memory");
+  return old;
+}
+
+intptr_t sync_xchg(volatile intptr_t *addr, intptr_t newval) {
+  // xchg with a memory operand is always locked
+  asm volatile("xchgl %0, %1" : "+r"(newval), "+m"(*addr) : : "memory");
+  return newval;
+}
+
+intptr_t sync_fetch_add(volatile intptr_t *addr, intptr_t val) {
+  asm volatile("lock xaddl %0, %1" : "+r"(val), "+m"(*addr) : : "memory");
+  return val;
+}
+
+#else
+
+intptr_t sync_cas(volatile intptr_t *addr, intptr_t expect, intptr_t newval) {
+  __atomic_compare_exchange_n(addr, &expect, newval, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+  return expect;
+}
+
+intptr_t sync_xchg(volatile intptr_t *addr, intptr_t newval) {
+  return __atomic_exchange_n(addr, newval, __ATOMIC_SEQ_CST);
+}
+
+intptr_t sync_fetch_add(volatile intptr_t *addr, intptr_t val) {
+  return __atomic_fetch_add(addr, val, __ATOMIC_SEQ_CST);
+}
+
+#endif
+
+static inline void cpu_relax() {
+#if defined(__ISA_X86__) || defined(__ISA_X86_64__) || defined(__ISA_NATIVE__)
+  asm volatile("pause");
+#endif
+}
+
+// Ticket lock: FIFO, and waiters only read `serving`.
+
+void ticket_lock(ticket_lock_t *lk) {
+  intptr_t ticket = sync_fetch_add(&lk->next, 1);
+  while (lk->serving != ticket) cpu_relax();
+  __sync_synchronize();
+}
+
+void ticket_unlock(ticket_lock_t *lk) {
+  __sync_synchronize();
+  lk->serving ++;
+}
+
+// MCS lock: each waiter spins on its own node, which the caller provides
+// and passes again to mcs_unlock().
+
+void mcs_lock(mcs_lock_t *lk, mcs_node_t *node) {
+  node->next = NULL;
+  node->wait = 1;
+  __sync_synchronize();
+  mcs_node_t *prev = (mcs_node_t *)sync_xchg((volatile intptr_t *)&lk->tail, (intptr_t)node);
+  if (prev != NULL) {
+    prev->next = node;
+    while (node->wait) cpu_relax();
+  }
+  __sync_synchronize();
+}
+
+void mcs_unlock(mcs_lock_t *lk, mcs_node_t *node) {
+  __sync_synchronize();
+  if (node->next == NULL) {
+    // no known successor: release the lock, unless one is enqueuing
+    if (sync_cas((volatile intptr_t *)&lk->tail, (intptr_t)node, 0) == (intptr_t)node) return;
+    while (node->next == NULL) cpu_relax();
+  }
+  node->next->wait = 0;
+}
+
+// Dissemination barrier over the _ncpu() CPUs. In round k, CPU i signals
+// CPU (i + 2^k) % n and waits for the signal from CPU (i - 2^k) % n, so
+// every CPU spins on a flag in its own cache line, written by exactly one
+// other CPU. Flags hold the number of the barrier episode, which only
+// grows, so they never need to be reset.
+
+typedef struct {
+  volatile intptr_t flag[LOG_MAX_CPU];
+  intptr_t episode;
+} __attribute__((aligned(CACHE_LINE))) barrier_node_t;
+
+static barrier_node_t barrier_node[MAX_CPU];
+
+void sync_barrier() {
+  int n = _ncpu(), i = _cpu();
+  if (n <= 1) return;
+  assert(n <= MAX_CPU);
+
+  barrier_node_t *me = &barrier_node[i];
+  intptr_t episode = ++ me->episode;
+  __sync_synchronize();
+  for (int k = 0, dist = 1; dist < n; k ++, dist <<= 1) {
+    barrier_node[(i + dist) % n].flag[k] = episode;
+    while (me->flag[k] < episode) cpu_relax();
+  }
+  __sync_synchronize();
+}
@@ -9,6 +9,7 @@ static const char *tests[256] = {
   ['e'] = "external interrupt (PLIC) test",
   ['d'] = "scan devices",
   ['m'] = "multiprocessor test",
+  ['y'] = "multiprocessor sync (klib locks and barrier) test",
   ['t'] = "real-time clock test",
   ['k'] = "readkey test",
   ['v'] = "display test",
@@ -26,6 +27,7 @@ int main(const char *args) {
     CASE('e', external_intr, IOE, NOTIMEINT(), CTE(external_trap), REEH(external_trap), RTEH(external_trap));
     CASE('d', devscan, IOE);
     CASE('m', finalize, PRE_MPE(args[1]), MPE(mp_print));
+    CASE('y', sync_finalize, PRE_MPE(args[1]), MPE(sync_mp));
     CASE('t', rtc_test, IOE);
     CASE('k', keyboard_test, IOE);
     CASE('v', video_test, IOE);
@@ -7,17 +7,47 @@ static void input_test() {
 
 static void timer_test() {
   _DEV_TIMER_UPTIME_t uptime;
+  _DEV_TIMER_USEC_t usec;
+  _DEV_TIMER_CYCLE_t cycle;
   uint32_t t0, t1;
+  uint64_t us0, us1, c0, c1;
 
   _io_read(_DEV_TIMER, _DEVREG_TIMER_UPTIME, &uptime, sizeof(uptime));
+  _io_read(_DEV_TIMER, _DEVREG_TIMER_USEC, &usec, sizeof(usec));
+  _io_read(_DEV_TIMER, _DEVREG_TIMER_CYCLE, &cycle, sizeof(cycle));
   t0 = uptime.lo;
+  us0 = usec.us;
+  c0 = cycle.cycle;
 
   for (int volatile i = 0; i < 10000000; i ++) ;
 
   _io_read(_DEV_TIMER, _DEVREG_TIMER_UPTIME, &uptime, sizeof(uptime));
+  _io_read(_DEV_TIMER, _DEVREG_TIMER_USEC, &usec, sizeof(usec));
+  _io_read(_DEV_TIMER, _DEVREG_TIMER_CYCLE, &cycle, sizeof(cycle));
   t1 = uptime.lo;
+  us1 = usec.us;
+  c1 = cycle.cycle;
 
   printf("Loop 10^7 time elapse: %d ms\n", t1 - t0);
+  printf("Loop 10^7 time elapse: %u us, %u cycles\n", (uint32_t)(us1 - us0), (uint32_t)(c1 - c0));
+}
+
+static void perfcnt_test() {
+  _DEV_PERFCNT_READ_t c0, c1;
+  c0.valid = c1.valid = 0;
+
+  _io_read(_DEV_PERFCNT, _DEVREG_PERFCNT_READ, &c0, sizeof(c0));
+  for (int volatile i = 0; i < 1000000; i ++) ;
+  _io_read(_DEV_PERFCNT, _DEVREG_PERFCNT_READ, &c1, sizeof(c1));
+
+  uint32_t valid = c1.valid;
+  printf("Loop 10^6 perf counters:");
+  if (valid & _PERFCNT_CYCLE)     printf(" cycle = %d", (uint32_t)(c1.cycle - c0.cycle));
+  if (valid & _PERFCNT_INSTRET)   printf(" instret = %d", (uint32_t)(c1.instret - c0.instret));
+  if (valid & _PERFCNT_CACHEMISS) printf(" cachemiss = %d", (uint32_t)(c1.cachemiss - c0.cachemiss));
+  if (valid & _PERFCNT_BRMISS)    printf(" brmiss = %d", (uint32_t)(c1.brmiss - c0.brmiss));
+  if (valid == 0) printf(" not supported");
+  printf("\n");
 }
 
 static void video_test() {
@@ -87,6 +117,7 @@ void devscan() {
   printf("_heap = [%08x, %08x)\n", _heap.start, _heap.end);
   input_test();
   timer_test();
+  perfcnt_test();
   video_test();
   storage_test();
   pciconf_test();
@@ -0,0 +1,54 @@
+#include <amtest.h>
+
+/*
+ * Contended checks of the klib sync primitives, e.g.
+ * `make ARCH=riscv64-xs-dual mainargs='y2'`
+ */
+
+#define NR_ROUND   10000
+#define NR_EPISODE 100
+
+static ticket_lock_t tlock = TICKET_LOCK_INIT;
+static mcs_lock_t mlock = MCS_LOCK_INIT;
+static volatile intptr_t ticket_sum = 0, mcs_sum = 0, fetch_add_sum = 0;
+static volatile intptr_t arrived = 0;
+
+void sync_mp() {
+  _mpe_wakeup(1);
+  int n = _ncpu();
+
+  for (int i = 0; i < NR_ROUND; i ++) {
+    ticket_lock(&tlock);
+    ticket_sum ++;
+    ticket_unlock(&tlock);
+
+    mcs_node_t node;
+    mcs_lock(&mlock, &node);
+    mcs_sum ++;
+    mcs_unlock(&mlock, &node);
+
+    sync_fetch_add(&fetch_add_sum, 1);
+  }
+
+  // no CPU leaves an episode before all of them have arrived,
+  // and none arrives at the next one before all have left
+  for (int e = 1; e <= NR_EPISODE; e ++) {
+    sync_fetch_add(&arrived, 1);
+    sync_barrier();
+    assert(arrived == e * n);
+    sync_barrier();
+  }
+}
+
+// run after sync_mp() on every CPU
+void sync_finalize() {
+  int n = _ncpu();
+  assert(ticket_sum == NR_ROUND * n);
+  assert(mcs_sum == NR_ROUND * n);
+  assert(fetch_add_sum == NR_ROUND * n);
+  sync_barrier();
+  if (_cpu() != 0) while (1);
+  printf("%d CPUs: ticket = %d, mcs = %d, fetch_add = %d, %d barrier episodes\n",
+    n, ticket_sum, mcs_sum, fetch_add_sum, NR_EPISODE);
+  printf("PASS!\n");
+}
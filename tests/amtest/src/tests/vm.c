@@ -83,6 +83,9 @@ void vm_test() {
   printf("Code copied to %p (physical %p) execute\n", ptr, pg);
 
   static uint8_t stack[4096];
+  // start from a dirty kernel stack, _ucontext() must initialize every
+  // field of the context it creates there
+  memset(stack, 0xff, sizeof(stack));
   uctx = _ucontext(&prot, RANGE(stack, stack + sizeof(stack)), ptr);
 
   _intr_write(1);
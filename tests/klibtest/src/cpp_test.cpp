@@ -0,0 +1,47 @@
+#include <klib.h>
+#include <new>
+
+static int nr_ctor = 0, nr_dtor = 0;
+
+struct Obj {
+  int val;
+  Obj(int v) : val(v) { nr_ctor ++; }
+  ~Obj() { nr_dtor ++; }
+};
+
+static Obj &get_static() {
+  static Obj obj(42); // guarded by __cxa_guard_acquire()
+  return obj;
+}
+
+static void report() {
+  // registered before the static object, so __cxa_finalize() has run
+  // its destructor, and only that one since cpp_test() reset nr_dtor
+  printf("atexit: %d destructor(s) run at _halt()\n", nr_dtor);
+  assert(nr_dtor == 1);
+}
+
+extern "C" void cpp_test() {
+  printf("Testing C++ runtime...\n");
+  atexit(report);
+
+  for (int i = 0; i < 10; i ++) assert(get_static().val == 42);
+  assert(nr_ctor == 1);
+
+  Obj *p = new Obj(1);
+  assert(p->val == 1 && nr_ctor == 2);
+  delete p;
+  assert(nr_dtor == 1);
+
+  Obj *arr = (Obj *)operator new[](4 * sizeof(Obj));
+  for (int i = 0; i < 4; i ++) new (&arr[i]) Obj(i); // placement new
+  for (int i = 0; i < 4; i ++) assert(arr[i].val == i);
+  for (int i = 0; i < 4; i ++) arr[i].~Obj();
+  operator delete[](arr);
+
+  int *q = new (std::nothrow) int[1024];
+  assert(q != NULL);
+  delete[] q;
+
+  nr_dtor = 0;
+}
@@ -2,11 +2,21 @@
 
 void printf_test();
 void memory_test();
+void malloc_test();
+void string_bench();
+void stdlib_test();
+void cpp_test();
+void sync_test();
 
 int main() {
   printf("Test start!\n");
   printf_test();
   memory_test();
+  malloc_test();
+  stdlib_test();
+  cpp_test();
+  sync_test();
+  string_bench();
   printf("Test end!\n");
   return 0;
 }
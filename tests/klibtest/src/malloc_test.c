@@ -0,0 +1,114 @@
+#include <klib.h>
+#include <klib-macros.h>
+
+#define NR_PTR 512
+#define NR_ROUND 20000
+#define NR_BENCH 1000000
+
+static uint8_t *ptr[NR_PTR];
+static size_t size[NR_PTR];
+
+static size_t rand_size() {
+  // mostly small objects, sometimes large ones
+  switch (rand() % 16) {
+    case 0: return rand() % (64 * 1024);
+    case 1: case 2: return rand() % 4096;
+    default: return rand() % 256;
+  }
+}
+
+static void fill(int i) {
+  for (size_t j = 0; j < size[i]; j ++) ptr[i][j] = i + j;
+}
+
+static void check(int i) {
+  for (size_t j = 0; j < size[i]; j ++) assert(ptr[i][j] == (uint8_t)(i + j));
+}
+
+static void alloc(int i, size_t sz) {
+  size[i] = sz;
+  ptr[i] = malloc(sz);
+  assert(ptr[i] != NULL);
+  assert((uintptr_t)ptr[i] % sizeof(uintptr_t) == 0);
+  fill(i);
+}
+
+static void release(int i) {
+  check(i);
+  free(ptr[i]);
+  ptr[i] = NULL;
+}
+
+static void test_nonoverlap(void) {
+  for (int i = 0; i < NR_PTR; i ++) alloc(i, rand_size());
+  for (int i = 0; i < NR_PTR; i ++) check(i);
+  for (int i = 0; i < NR_PTR; i += 2) release(i);
+  for (int i = 0; i < NR_PTR; i += 2) alloc(i, rand_size());
+  for (int i = 0; i < NR_PTR; i ++) release(i);
+}
+
+static void test_random(void) {
+  for (int r = 0; r < NR_ROUND; r ++) {
+    int i = rand() % NR_PTR;
+    if (ptr[i] == NULL) alloc(i, rand_size());
+    else release(i);
+  }
+  for (int i = 0; i < NR_PTR; i ++) {
+    if (ptr[i] != NULL) release(i);
+  }
+}
+
+static void test_reuse(void) {
+  // the heap would be exhausted if freed memory were not reused
+  for (int r = 0; r < NR_ROUND; r ++) {
+    void *p = malloc(1024 * 1024);
+    assert(p != NULL);
+    free(p);
+  }
+  free(NULL);
+}
+
+static void test_huge(void) {
+  // requests larger than the heap must fail instead of wrapping around
+  assert(malloc((size_t)-1) == NULL);
+  assert(malloc((size_t)-1 - 4096) == NULL);
+  assert(malloc(_heap.end - _heap.start + 1) == NULL);
+}
+
+static void bench(const char *name, void (*f)(void)) {
+  uint64_t t0 = uptime_us();
+  f();
+  uint64_t us = uptime_us() - t0;
+  printf("  %s: %d ops in %d us\n", name, NR_BENCH, (int)us);
+}
+
+static void bench_pair(void) {
+  for (int i = 0; i < NR_BENCH; i ++) {
+    void *p = malloc(i % 128 + 1);
+    free(p);
+  }
+}
+
+static void bench_batch(void) {
+  // allocate a batch, then free it in the same order
+  for (int i = 0; i < NR_BENCH; i += NR_PTR) {
+    for (int j = 0; j < NR_PTR; j ++) ptr[j] = malloc(j % 512 + 1);
+    for (int j = 0; j < NR_PTR; j ++) free(ptr[j]);
+  }
+  for (int j = 0; j < NR_PTR; j ++) ptr[j] = NULL;
+}
+
+static void kernel(void (*k)(void), const char *name) {
+  printf("Testing %s...\n", name);
+  k();
+}
+
+void malloc_test() {
+  kernel(test_nonoverlap, "malloc (non-overlap)");
+  kernel(test_random, "malloc (random)");
+  kernel(test_reuse, "malloc (reuse)");
+  kernel(test_huge, "malloc (huge)");
+  printf("Benchmarking malloc...\n");
+  bench("malloc/free pair", bench_pair);
+  bench("malloc/free batch", bench_batch);
+}
@@ -56,6 +56,27 @@ static void test_memmove(void) {
   }
 }
 
+// Move [src, src + len) to dst inside a larger buffer, for all pairs of
+// offsets around word boundaries and lengths long enough to reach the
+// word loops, then check against a copy through a temporary buffer.
+#define OVL_N 320
+#define OVL_OFF 24
+static uint8_t ovl[OVL_N], ref[OVL_N], tmp[OVL_N];
+
+static void test_memmove_overlap(void) {
+  for (int st = 0; st < OVL_OFF; st ++) {
+    for (int cp = 0; cp < OVL_OFF; cp ++) {
+      for (int len = 0; len + OVL_OFF <= OVL_N; len += (len < 80 ? 1 : 13)) {
+        for (int i = 0; i < OVL_N; i ++) ovl[i] = ref[i] = i * 7 + 1;
+        memmove(ovl + st, ovl + cp, len);
+        for (int i = 0; i < len; i ++) tmp[i] = ref[cp + i];
+        for (int i = 0; i < len; i ++) ref[st + i] = tmp[i];
+        for (int i = 0; i < OVL_N; i ++) assert(ovl[i] == ref[i]);
+      }
+    }
+  }
+}
+
 static void test_memcpy(void) {
   for (int st = 0; st < N; st ++) {
     for (int ed = st + 1; ed <= N; ed ++) {
@@ -112,6 +133,7 @@ static void kernel(void (*k)(void), const char *name) {
 void memory_test() {
   kernel(test_memset, "memset");
   kernel(test_memmove, "memmove");
+  kernel(test_memmove_overlap, "memmove (overlap)");
   kernel(test_memcpy, "memcpy");
   kernel(test_strcpy, "strcpy");
   kernel(test_strcmp, "strcmp");
@@ -0,0 +1,177 @@
+#include <klib.h>
+#include <klib-macros.h>
+#include <limits.h>
+
+#define NR_SORT 4096
+#define NR_BENCH (64 * 1024)
+
+static int data[NR_BENCH];
+static int copy[NR_BENCH];
+
+static int cmp_int(const void *a, const void *b) {
+  int x = *(const int *)a, y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+// elements of an odd size, to exercise the byte-wise swap
+typedef struct { char key; char pad[6]; } Odd;
+
+static int cmp_odd(const void *a, const void *b) {
+  return ((const Odd *)a)->key - ((const Odd *)b)->key;
+}
+
+static void check_sorted(int *a, int n) {
+  for (int i = 1; i < n; i ++) assert(a[i - 1] <= a[i]);
+}
+
+static int sum(int *a, int n) {
+  int s = 0;
+  for (int i = 0; i < n; i ++) s += a[i];
+  return s;
+}
+
+static void fill(int *a, int n, int pattern) {
+  for (int i = 0; i < n; i ++) {
+    switch (pattern) {
+      case 0: a[i] = rand(); break;
+      case 1: a[i] = i; break;                  // sorted
+      case 2: a[i] = n - i; break;              // reversed
+      case 3: a[i] = rand() % 4; break;         // many duplicates
+      default: a[i] = (i % 2 ? i : n - i); break; // organ pipe
+    }
+  }
+}
+
+static void test_qsort(void) {
+  for (int pattern = 0; pattern < 5; pattern ++) {
+    for (int n = 0; n <= NR_SORT; n = (n < 64 ? n + 1 : n * 2)) {
+      fill(data, n, pattern);
+      int s = sum(data, n);
+      qsort(data, n, sizeof(int), cmp_int);
+      check_sorted(data, n);
+      assert(sum(data, n) == s);
+    }
+  }
+
+  static Odd odd[NR_SORT];
+  for (int i = 0; i < NR_SORT; i ++) {
+    odd[i].key = rand() % 100;
+    memset(odd[i].pad, odd[i].key, sizeof(odd[i].pad));
+  }
+  qsort(odd, NR_SORT, sizeof(Odd), cmp_odd);
+  for (int i = 0; i < NR_SORT; i ++) {
+    if (i > 0) assert(odd[i - 1].key <= odd[i].key);
+    for (size_t j = 0; j < sizeof(odd[i].pad); j ++) assert(odd[i].pad[j] == odd[i].key);
+  }
+}
+
+static void test_bsearch(void) {
+  for (int i = 0; i < NR_SORT; i ++) data[i] = i * 2;
+  for (int i = 0; i < NR_SORT; i ++) {
+    int key = i * 2;
+    int *p = bsearch(&key, data, NR_SORT, sizeof(int), cmp_int);
+    assert(p == &data[i]);
+    key = i * 2 + 1;
+    assert(bsearch(&key, data, NR_SORT, sizeof(int), cmp_int) == NULL);
+  }
+  int key = -1;
+  assert(bsearch(&key, data, NR_SORT, sizeof(int), cmp_int) == NULL);
+  assert(bsearch(&key, data, 0, sizeof(int), cmp_int) == NULL);
+}
+
+static void test_strtol(void) {
+  char *end;
+  assert(strtol("  -123abc", &end, 10) == -123 && *end == 'a');
+  assert(strtol("+42", NULL, 10) == 42);
+  assert(strtol("0x1F", &end, 0) == 31 && *end == '\0');
+  assert(strtol("0x1F", &end, 16) == 31 && *end == '\0');
+  assert(strtol("0x", &end, 16) == 0 && *end == 'x');
+  assert(strtol("0777", NULL, 0) == 0777);
+  assert(strtol("z", NULL, 36) == 35);
+  assert(strtol("xyz", &end, 10) == 0 && *end == 'x');
+  assert(strtol("99999999999999999999999", NULL, 10) == LONG_MAX);
+  assert(strtol("-99999999999999999999999", NULL, 10) == LONG_MIN);
+  assert(strtoul("-1", NULL, 10) == ULONG_MAX);
+  assert(strtoul("99999999999999999999999", NULL, 10) == ULONG_MAX);
+  const char *num = "123";
+  assert(strtol(num, &end, 1) == 0 && end == num);
+  assert(strtol(num, &end, 37) == 0 && end == num);
+  assert(strtol(num, &end, -2) == 0 && end == num);
+  assert(strtoul(num, &end, 37) == 0 && end == num);
+}
+
+static void test_strsearch(void) {
+  static char s[] = "the quick brown fox jumps over the lazy dog";
+  assert(strchr(s, 'q') == s + 4);
+  assert(strchr(s, 'g') == s + strlen(s) - 1);
+  assert(strchr(s, '!') == NULL);
+  assert(strchr(s, '\0') == s + strlen(s));
+  assert(strrchr(s, 't') == s + 31);
+  assert(strrchr(s, '!') == NULL);
+  assert(strstr(s, "the") == s);
+  assert(strstr(s, "the lazy") == s + 31);
+  assert(strstr(s, "dog") == s + strlen(s) - 3);
+  assert(strstr(s, "cat") == NULL);
+  assert(strstr(s, "") == s);
+
+  char buf[] = ",,a,bb,,ccc,";
+  assert(strcmp(strtok(buf, ","), "a") == 0);
+  assert(strcmp(strtok(NULL, ","), "bb") == 0);
+  assert(strcmp(strtok(NULL, ","), "ccc") == 0);
+  assert(strtok(NULL, ",") == NULL);
+}
+
+// the hand-written sort used by microbench, for comparison
+static void swap(int *a, int *b) {
+  int t = *a;
+  *a = *b;
+  *b = t;
+}
+
+static void myqsort(int *a, int l, int r) {
+  if (l < r) {
+    int p = a[l], pivot = l, j;
+    for (j = l + 1; j < r; j ++) {
+      if (a[j] < p) {
+        swap(&a[++pivot], &a[j]);
+      }
+    }
+    swap(&a[pivot], &a[l]);
+    myqsort(a, l, pivot);
+    myqsort(a, pivot + 1, r);
+  }
+}
+
+static void bench_sort(const char *name, int pattern, int n) {
+  fill(copy, n, pattern);
+
+  memcpy(data, copy, n * sizeof(int));
+  uint64_t t0 = uptime_us();
+  myqsort(data, 0, n);
+  uint64_t t_my = uptime_us() - t0;
+
+  memcpy(data, copy, n * sizeof(int));
+  t0 = uptime_us();
+  qsort(data, n, sizeof(int), cmp_int);
+  uint64_t t_klib = uptime_us() - t0;
+  check_sorted(data, n);
+
+  printf("  %s (%d ints): myqsort %d us, qsort %d us\n", name, n, (int)t_my, (int)t_klib);
+}
+
+static void kernel(void (*k)(void), const char *name) {
+  printf("Testing %s...\n", name);
+  k();
+}
+
+void stdlib_test() {
+  kernel(test_qsort, "qsort");
+  kernel(test_bsearch, "bsearch");
+  kernel(test_strtol, "strtol");
+  kernel(test_strsearch, "strchr/strrchr/strstr/strtok");
+  printf("Benchmarking qsort...\n");
+  bench_sort("random", 0, NR_BENCH);
+  // myqsort degrades to O(n^2) and deep recursion here, so keep it small
+  bench_sort("sorted", 1, NR_SORT);
+  bench_sort("duplicates", 3, NR_SORT);
+}
@@ -0,0 +1,74 @@
+#include <klib.h>
+#include <klib-macros.h>
+
+// Throughput of the string routines in bytes/cycle, for several sizes
+// and alignments of the operands.
+
+#define MAX_SIZE 4096
+#define BUF_SIZE (MAX_SIZE + 64)
+#define TOTAL (256 * 1024) // bytes processed per measurement
+
+static char src[BUF_SIZE] __attribute__((aligned(64)));
+static char dst[BUF_SIZE] __attribute__((aligned(64)));
+
+static const int sizes[] = { 8, 64, 512, MAX_SIZE };
+static const int aligns[][2] = { {0, 0}, {1, 1}, {0, 3}, {5, 2} }; // offsets of {dst, src}
+
+static volatile size_t sink;
+
+static void op_strlen (char *d, char *s, int n) { sink = strlen(s); }
+static void op_strcpy (char *d, char *s, int n) { strcpy(d, s); }
+static void op_strncpy(char *d, char *s, int n) { strncpy(d, s, n); }
+static void op_strcat (char *d, char *s, int n) { d[0] = '\0'; strcat(d, s); }
+static void op_strcmp (char *d, char *s, int n) { sink = strcmp(d, s); }
+static void op_strncmp(char *d, char *s, int n) { sink = strncmp(d, s, n); }
+static void op_memcmp (char *d, char *s, int n) { sink = memcmp(d, s, n); }
+static void op_memcpy (char *d, char *s, int n) { memcpy(d, s, n); }
+static void op_memmove(char *d, char *s, int n) { memmove(d, s, n); }
+static void op_memset (char *d, char *s, int n) { memset(d, n, n); }
+
+static struct {
+  const char *name;
+  void (*op)(char *d, char *s, int n);
+} ops[] = {
+  { "strlen", op_strlen }, { "strcpy", op_strcpy }, { "strncpy", op_strncpy },
+  { "strcat", op_strcat }, { "strcmp", op_strcmp }, { "strncmp", op_strncmp },
+  { "memcmp", op_memcmp }, { "memcpy", op_memcpy }, { "memmove", op_memmove },
+  { "memset", op_memset },
+};
+
+static void setup(char *d, char *s, int n) {
+  // strings of length n - 1, equal in both buffers, so that
+  // comparisons run through the whole length
+  for (int i = 0; i < n - 1; i ++) s[i] = d[i] = 'a' + i % 26;
+  s[n - 1] = d[n - 1] = '\0';
+}
+
+static void measure(int k, int n, int da, int sa) {
+  char *d = dst + da, *s = src + sa;
+  int iter = TOTAL / n;
+  setup(d, s, n);
+  ops[k].op(d, s, n); // warm up
+
+  uint64_t c0 = read_cycle();
+  for (int i = 0; i < iter; i ++) ops[k].op(d, s, n);
+  uint64_t cycles = read_cycle() - c0;
+
+  if (cycles == 0) {
+    printf("  %s\t%d\t%d/%d\tn/a\n", ops[k].name, n, da, sa);
+  } else {
+    // print with two decimal places without relying on float support
+    uint64_t x100 = (uint64_t)iter * n * 100 / cycles;
+    printf("  %s\t%d\t%d/%d\t%d.%d%d\n", ops[k].name, n, da, sa,
+      (int)(x100 / 100), (int)(x100 / 10 % 10), (int)(x100 % 10));
+  }
+}
+
+void string_bench() {
+  printf("Benchmarking string routines...\n");
+  printf("  name\tsize\tdst/src\tbytes/cycle\n");
+  for (int k = 0; k < LENGTH(ops); k ++)
+    for (int i = 0; i < LENGTH(sizes); i ++)
+      for (int j = 0; j < LENGTH(aligns); j ++)
+        measure(k, sizes[i], aligns[j][0], aligns[j][1]);
+}
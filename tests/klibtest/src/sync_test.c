@@ -0,0 +1,63 @@
+#include <klib.h>
+#include <klib-macros.h>
+
+// Single-CPU checks of the sync primitives; klibtest does not start
+// other CPUs. The contended checks are amtest's `y` test.
+
+#define NR_BENCH 100000
+
+static volatile intptr_t x;
+static ticket_lock_t tlock = TICKET_LOCK_INIT;
+static mcs_lock_t mlock = MCS_LOCK_INIT;
+
+static void test_atomic(void) {
+  x = 5;
+  assert(sync_cas(&x, 4, 10) == 5 && x == 5);
+  assert(sync_cas(&x, 5, 10) == 5 && x == 10);
+  assert(sync_xchg(&x, 3) == 10 && x == 3);
+  assert(sync_fetch_add(&x, 4) == 3 && x == 7);
+  assert(sync_fetch_add(&x, -7) == 7 && x == 0);
+}
+
+static void test_lock(void) {
+  for (int i = 0; i < 10; i ++) {
+    ticket_lock(&tlock);
+    ticket_unlock(&tlock);
+  }
+  assert(tlock.next == 10 && tlock.serving == 10);
+
+  mcs_node_t node;
+  for (int i = 0; i < 10; i ++) {
+    mcs_lock(&mlock, &node);
+    assert(mlock.tail == &node);
+    mcs_unlock(&mlock, &node);
+    assert(mlock.tail == NULL);
+  }
+
+  sync_barrier();
+}
+
+static void bench(const char *name, void (*f)(void)) {
+  uint64_t t0 = uptime_us();
+  for (int i = 0; i < NR_BENCH; i ++) f();
+  uint64_t us = uptime_us() - t0;
+  printf("  %s: %d ops in %d us\n", name, NR_BENCH, (int)us);
+}
+
+static void op_fetch_add(void) { sync_fetch_add(&x, 1); }
+static void op_ticket(void) { ticket_lock(&tlock); ticket_unlock(&tlock); }
+static void op_mcs(void) { mcs_node_t node; mcs_lock(&mlock, &node); mcs_unlock(&mlock, &node); }
+
+static void kernel(void (*k)(void), const char *name) {
+  printf("Testing %s...\n", name);
+  k();
+}
+
+void sync_test() {
+  kernel(test_atomic, "atomics");
+  kernel(test_lock, "spinlocks and barrier");
+  printf("Benchmarking uncontended sync...\n");
+  bench("fetch_add", op_fetch_add);
+  bench("ticket lock/unlock", op_ticket);
+  bench("mcs lock/unlock", op_mcs);
+}
@@ -0,0 +1,69 @@
+#include <am.h>
+#include <klib.h>
+#include <klib-macros.h>
+
+// Cycles per operation of 64-bit multiplication and division. On 32-bit
+// ISAs these are calls into the soft helpers in klib (__muldi3, __udivdi3,
+// ...), so this measures them for operands of different magnitudes.
+
+#define NR_OPND 64
+#define NR_ITER 64
+
+static uint64_t x[NR_OPND], y[NR_OPND];
+static volatile uint64_t sink;
+
+static uint64_t rand64(void) {
+  // rand() only gives 15 bits
+  uint64_t r = 0;
+  for (int i = 0; i < 5; i ++) r = (r << 15) ^ rand();
+  return r;
+}
+
+// dividend and divisor widths in bits
+static void setup(int xbits, int ybits) {
+  for (int i = 0; i < NR_OPND; i ++) {
+    x[i] = rand64() >> (64 - xbits);
+    y[i] = (rand64() >> (64 - ybits)) | 1;
+  }
+}
+
+static void op_mul (void) { for (int i = 0; i < NR_OPND; i ++) sink = x[i] * y[i]; }
+static void op_udiv(void) { for (int i = 0; i < NR_OPND; i ++) sink = x[i] / y[i]; }
+static void op_umod(void) { for (int i = 0; i < NR_OPND; i ++) sink = x[i] % y[i]; }
+static void op_sdiv(void) { for (int i = 0; i < NR_OPND; i ++) sink = (int64_t)x[i] / (int64_t)y[i]; }
+static void op_smod(void) { for (int i = 0; i < NR_OPND; i ++) sink = (int64_t)x[i] % (int64_t)y[i]; }
+
+static struct {
+  const char *name;
+  void (*op)(void);
+} ops[] = {
+  { "mul", op_mul }, { "udiv", op_udiv }, { "umod", op_umod },
+  { "sdiv", op_sdiv }, { "smod", op_smod },
+};
+
+static const int widths[][2] = { {32, 16}, {64, 16}, {64, 32}, {64, 48}, {63, 62} };
+
+static void measure(int k, int w) {
+  srand(k * LENGTH(widths) + w + 1);
+  setup(widths[w][0], widths[w][1]);
+  ops[k].op(); // warm up
+
+  uint64_t c0 = read_cycle();
+  for (int i = 0; i < NR_ITER; i ++) ops[k].op();
+  uint64_t cycles = read_cycle() - c0;
+
+  if (cycles == 0) {
+    printf("  %s\t%d/%d\tn/a\n", ops[k].name, widths[w][0], widths[w][1]);
+  } else {
+    printf("  %s\t%d/%d\t%d\n", ops[k].name, widths[w][0], widths[w][1],
+      (int)(cycles / (NR_ITER * NR_OPND)));
+  }
+}
+
+void bench() {
+  printf("Benchmarking 64-bit mul/div...\n");
+  printf("  op\tbits\tcycles/op\n");
+  for (int k = 0; k < LENGTH(ops); k ++)
+    for (int w = 0; w < LENGTH(widths); w ++)
+      measure(k, w);
+}
@@ -0,0 +1,97 @@
+#include <am.h>
+#include <klib.h>
+#include <klib-macros.h>
+
+// Check the 64-bit division and bit counting helpers in klib against
+// bit-serial reference implementations which only shift and subtract.
+
+uint64_t __udivmoddi4(uint64_t a, uint64_t b, uint64_t *rem);
+int __clzsi2(unsigned int a);
+int __ctzsi2(unsigned int a);
+
+static uint64_t ref_udivmod(uint64_t a, uint64_t b, uint64_t *rem) {
+  uint64_t q = 0, r = 0;
+  for (int i = 63; i >= 0; i --) {
+    int carry = r >> 63;
+    r = (r << 1) | ((a >> i) & 1);
+    if (carry || r >= b) {
+      r -= b;
+      q |= 1ull << i;
+    }
+  }
+  *rem = r;
+  return q;
+}
+
+static int ref_clz(uint32_t a) {
+  int n = 0;
+  for (uint32_t m = 1u << 31; m != 0 && !(a & m); m >>= 1) n ++;
+  return n;
+}
+
+static int ref_ctz(uint32_t a) {
+  int n = 0;
+  for (uint32_t m = 1; m != 0 && !(a & m); m <<= 1) n ++;
+  return n;
+}
+
+static void check_udivmod(uint64_t x, uint64_t y) {
+  uint64_t rr, r = 0xdeadbeef;
+  uint64_t rq = ref_udivmod(x, y, &rr);
+  uint64_t q = __udivmoddi4(x, y, &r);
+  uint64_t q0 = __udivmoddi4(x, y, NULL);
+  if (q != rq || r != rr || q0 != rq || x / y != rq || x % y != rr) {
+    printf("x = 0x%016llx, y = 0x%016llx\n", x, y);
+    printf("right: q = 0x%016llx, r = 0x%016llx\nwrong: q = 0x%016llx, r = 0x%016llx\n",
+        rq, rr, q, r);
+    assert(0);
+  }
+}
+
+static void check_bits(uint32_t x) {
+  if (x != 0) assert(__clzsi2(x) == ref_clz(x));
+  assert(__ctzsi2(x) == ref_ctz(x));
+}
+
+static uint64_t rand64(void) {
+  uint64_t r = 0;
+  for (int i = 0; i < 5; i ++) r = (r << 15) ^ rand();
+  return r;
+}
+
+static const uint64_t v64[] = {
+  0, 1, 2, 3, 7, 10, 0x10, 0xffff, 0x7fffffff, 0x80000000, 0xffffffff,
+  0x100000000ull, 0x100000001ull, 0x123456789abcdefull, 0x7fffffffffffffffull,
+  0x8000000000000000ull, 0x8000000000000001ull, 0xfffffffeffffffffull,
+  0xfffffffffffffffeull, 0xffffffffffffffffull,
+};
+
+void int64_test() {
+  // divisor 1, divisor > dividend, high bit set, UINT64_MAX, ...
+  for (int i = 0; i < LENGTH(v64); i ++) {
+    for (int j = 1; j < LENGTH(v64); j ++) {
+      check_udivmod(v64[i], v64[j]);
+    }
+  }
+  // power-of-two divisors
+  for (int s = 0; s < 64; s ++) {
+    check_udivmod(0xffffffffffffffffull, 1ull << s);
+    check_udivmod(0x123456789abcdefull, 1ull << s);
+  }
+  // random operands of all widths
+  srand(1);
+  for (int i = 0; i < 4096; i ++) {
+    uint64_t x = rand64() >> (rand() % 64);
+    uint64_t y = rand64() >> (rand() % 64);
+    if (y != 0) check_udivmod(x, y);
+  }
+
+  assert(__clzsi2(0) == 32 && __ctzsi2(0) == 32);
+  assert(__clzsi2(1u << 31) == 0 && __ctzsi2(1u << 31) == 31);
+  for (int s = 0; s < 32; s ++) {
+    check_bits(1u << s);
+    check_bits((1u << s) | 1);
+    check_bits(0xffffffffu << s);
+    check_bits(0xffffffffu >> s);
+  }
+}
@@ -120,6 +120,9 @@ void check_divu(uint32_t x, uint32_t y) {
   }
 }
 
+void bench();
+void int64_test();
+
 int v[] = {0, 1, 2, 3, 0x7fffffff, 0x80000000, 0x80000001, 0xfffffffd, 0xfffffffe, 0xffffffff};
 
 int main() {
@@ -131,6 +134,9 @@ int main() {
       check_divu(v[i], v[j]);
     }
   }
+  int64_test();
   printf("PASS!\n");
+  _ioe_init();
+  bench();
   return 0;
 }